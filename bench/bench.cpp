@@ -0,0 +1,388 @@
+#include "../cdk.hpp"
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+cdk::headless_terminal& terminal()
+{
+	static cdk::headless_terminal term(120,40);
+	return term;
+}
+
+std::vector<std::string> makeItems(std::size_t count)
+{
+	std::vector<std::string> items;
+	for (std::size_t i = 0; i < count; ++i)
+		items.push_back("item-" + std::to_string(i * 7919 % count));
+	return items;
+}
+
+cdk::StringList views(const std::vector<std::string>& items)
+{
+	return cdk::StringList(items.begin(),items.end());
+}
+
+std::string makeFile(std::size_t lines)
+{
+	std::string path = (std::filesystem::temp_directory_path() / ("bench-" + std::to_string(lines) + ".txt")).string();
+	if (!std::filesystem::exists(path))
+	{
+		std::ofstream out(path);
+		for (auto& item : makeItems(lines))
+			out << item << " some more text to make a typical log line\n";
+	}
+	return path;
+}
+
+void reportOutput(benchmark::State& state,std::size_t bytes)
+{
+	state.counters["bytes/iter"] = benchmark::Counter(
+	            static_cast<double>(bytes),benchmark::Counter::kAvgIterations);
+}
+
+}
+
+static void label_construct(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	for (auto _ : state)
+	{
+		cdk::label l(s,{0,0},{"construct","destroy"},{true,false});
+		benchmark::DoNotOptimize(l._vptr);
+	}
+}
+BENCHMARK(label_construct);
+
+static void button_construct(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	for (auto _ : state)
+	{
+		cdk::button b(s,{0,0},"button",nullptr,{true,false});
+		benchmark::DoNotOptimize(b._vptr);
+	}
+}
+BENCHMARK(button_construct);
+
+static void text_entry_construct(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	for (auto _ : state)
+	{
+		cdk::text_entry e(s,{0,0},"title","label",A_NORMAL,'.',vMIXED,20,0,64,{true,false});
+		benchmark::DoNotOptimize(e._vptr);
+	}
+}
+BENCHMARK(text_entry_construct);
+
+static void alpha_list_construct(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	auto list = views(items);
+	for (auto _ : state)
+	{
+		cdk::alpha_list al(s,{0,0},{30,20},"title","find",list,'_',A_REVERSE,{true,false});
+		benchmark::DoNotOptimize(al._vptr);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(alpha_list_construct)->RangeMultiplier(8)->Range(8,32768)->Complexity();
+
+static void alpha_list_construct_prepared(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	auto list = views(items);
+	for (auto _ : state)
+	{
+		cdk::alpha_list al(s,{0,0},{30,20},"title","find",list,'_',A_REVERSE,{true,false},
+		                   {true,true,true,0});
+		benchmark::DoNotOptimize(al._vptr);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(alpha_list_construct_prepared)->RangeMultiplier(8)->Range(8,262144)->Complexity();
+
+static void alpha_list_construct_moved(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		auto copy = items;
+		state.ResumeTiming();
+		cdk::alpha_list al(s,{0,0},{30,20},"title","find",std::move(copy),'_',A_REVERSE,{true,false});
+		benchmark::DoNotOptimize(al._vptr);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(alpha_list_construct_moved)->RangeMultiplier(8)->Range(8,32768)->Complexity();
+
+static void calendar_construct(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	for (auto _ : state)
+	{
+		cdk::calendar c(s,{0,0},"calendar",{16,10,2026},{A_NORMAL,A_NORMAL,A_BOLD},A_REVERSE,{true,false});
+		benchmark::DoNotOptimize(c._vptr);
+	}
+}
+BENCHMARK(calendar_construct);
+
+static void label_setMessage(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto lines = makeItems(static_cast<std::size_t>(state.range(0)));
+	auto message = views(lines);
+	cdk::label l(s,{0,0},message,{true,false});
+	for (auto _ : state)
+		l.setMessage(message);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(label_setMessage)->RangeMultiplier(4)->Range(1,256);
+
+static void label_getMessage(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto lines = makeItems(static_cast<std::size_t>(state.range(0)));
+	cdk::label l(s,{0,0},views(lines),{true,false});
+	for (auto _ : state)
+	{
+		auto message = l.getMessage();
+		benchmark::DoNotOptimize(message);
+	}
+}
+BENCHMARK(label_getMessage)->RangeMultiplier(4)->Range(1,256);
+
+static void alpha_list_setContents(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	auto list = views(items);
+	cdk::alpha_list al(s,{0,0},{30,20},"title","find",list,'_',A_REVERSE,{true,false});
+	for (auto _ : state)
+		al.setContents(list);
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(alpha_list_setContents)->RangeMultiplier(8)->Range(8,32768)->Complexity();
+
+static void alpha_list_getContents(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	cdk::alpha_list al(s,{0,0},{30,20},"title","find",views(items),'_',A_REVERSE,{true,false});
+	for (auto _ : state)
+	{
+		auto contents = al.getContents();
+		benchmark::DoNotOptimize(contents);
+	}
+}
+BENCHMARK(alpha_list_getContents)->RangeMultiplier(8)->Range(8,32768);
+
+static void alpha_list_filter_keystroke(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto items = makeItems(static_cast<std::size_t>(state.range(0)));
+	cdk::alpha_list al(s,{0,0},{30,20},"title","find",views(items),'_',A_REVERSE,{true,false});
+	for (auto _ : state)
+	{
+		al.filter("1");
+		al.filter("12");
+		al.filter("");
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(alpha_list_filter_keystroke)->RangeMultiplier(8)->Range(8,262144)->Complexity();
+
+static void screen_refresh(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	std::vector<cdk::label> labels(static_cast<std::size_t>(state.range(0)));
+	for (std::size_t i = 0; i < labels.size(); ++i)
+	{
+		auto text = "label " + std::to_string(i);
+		labels[i] = cdk::label(s,{static_cast<int>(i % 6) * 20,static_cast<int>(i / 6) * 3},{text},{true,false});
+	}
+	terminal().clearOutput();
+	for (auto _ : state)
+		s.refresh();
+	reportOutput(state,terminal().bytesWritten());
+}
+BENCHMARK(screen_refresh)->Arg(1)->Arg(10)->Arg(40)->Arg(72);
+
+static void screen_refreshDirty(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	std::vector<cdk::label> labels(static_cast<std::size_t>(state.range(0)));
+	for (std::size_t i = 0; i < labels.size(); ++i)
+	{
+		auto text = "label " + std::to_string(i);
+		labels[i] = cdk::label(s,{static_cast<int>(i % 6) * 20,static_cast<int>(i / 6) * 3},{text},{true,false});
+	}
+	s.refresh();
+	terminal().clearOutput();
+	int tick = 0;
+	for (auto _ : state)
+	{
+		auto text = std::to_string(tick++);
+		labels[0].setMessage({text});
+		s.refreshDirty();
+	}
+	reportOutput(state,terminal().bytesWritten());
+}
+BENCHMARK(screen_refreshDirty)->Arg(1)->Arg(10)->Arg(40)->Arg(72);
+
+static std::vector<cdk::label> makeLabels(cdk::screen& s,std::size_t count)
+{
+	std::vector<cdk::label> labels(count);
+	for (std::size_t i = 0; i < labels.size(); ++i)
+	{
+		auto text = "label " + std::to_string(i);
+		labels[i] = cdk::label(s,{static_cast<int>(i % 6) * 20,static_cast<int>(i / 6) * 3},{text},{true,false});
+	}
+	return labels;
+}
+
+static void label_theme_setters(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto labels = makeLabels(s,static_cast<std::size_t>(state.range(0)));
+	s.refresh();
+	terminal().clearOutput();
+	for (auto _ : state)
+	{
+		for (auto& l : labels)
+		{
+			l.setULChar('+');
+			l.setURChar('+');
+			l.setLLChar('+');
+			l.setLRChar('+');
+			l.setHorizontalChar('-');
+			l.setVerticalChar('|');
+			l.setBoxAttribute(A_BOLD);
+			l.setBackgroundAttrib(A_NORMAL);
+		}
+		s.refreshDirty();
+	}
+	reportOutput(state,terminal().bytesWritten());
+}
+BENCHMARK(label_theme_setters)->Arg(10)->Arg(72);
+
+static void label_theme_applyStyle(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	auto labels = makeLabels(s,static_cast<std::size_t>(state.range(0)));
+	s.refresh();
+	terminal().clearOutput();
+	cdk::style theme{'+','+','+','+','-','|',A_BOLD,A_NORMAL};
+	for (auto _ : state)
+		cdk::applyStyle(labels,theme);
+	reportOutput(state,terminal().bytesWritten());
+}
+BENCHMARK(label_theme_applyStyle)->Arg(10)->Arg(72);
+
+static void log_viewer_append(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	cdk::log_viewer log(s,{0,0},{80,20},"log",static_cast<std::size_t>(state.range(0)),A_REVERSE,{true,false});
+	auto lines = makeItems(1024);
+	std::size_t i = 0;
+	for (auto _ : state)
+		log.append(lines[i++ % lines.size()]);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(log_viewer_append)->Arg(1000)->Arg(100000);
+
+static void scrolling_window_append(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	cdk::scrolling_window log(s,{0,0},{80,20},"log",1000,{true,false});
+	std::string chunk;
+	for (auto& line : makeItems(static_cast<std::size_t>(state.range(0))))
+		chunk += line + " some more text to make a typical log line\n";
+	for (auto _ : state)
+	{
+		log.append(chunk);
+		s.refreshDirty();
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk.size()));
+}
+BENCHMARK(scrolling_window_append)->Arg(1)->Arg(100)->Arg(5000);
+
+static void line_index_build(benchmark::State& state)
+{
+	std::string text;
+	for (auto& item : makeItems(1000000))
+		text += item + " some more text to make a typical log line\n";
+	for (auto _ : state)
+	{
+		cdk::line_index index(text,{},static_cast<unsigned>(state.range(0)));
+		while (!index.done())
+			std::this_thread::yield();
+		benchmark::DoNotOptimize(index.lineCount());
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(line_index_build)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void file_viewer_first_screen(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	std::string path = makeFile(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		cdk::file_viewer viewer(s,{0,0},{80,20},path,"file",{true,false});
+		while (viewer.lineCount() < 18 && !viewer.isIndexed())
+		{
+			pollfd wake{s.updates().wakeFd(),POLLIN,0};
+			poll(&wake,1,1);
+		}
+		s.refreshDirty();
+	}
+}
+BENCHMARK(file_viewer_first_screen)->Arg(1000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+static void file_viewer_page(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	cdk::file_viewer viewer(s,{0,0},{80,20},makeFile(1000000),"file",{true,false});
+	while (!viewer.isIndexed())
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	s.refreshDirty();
+	for (auto _ : state)
+	{
+		viewer.inject(KEY_NPAGE);
+		if (viewer.getTopLine() + 100 > viewer.lineCount())
+			viewer.inject(KEY_HOME);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(file_viewer_page);
+
+static void matrix_page(benchmark::State& state)
+{
+	cdk::screen s(terminal().window());
+	std::vector<std::string> titles;
+	for (int c = 0; c < 50; ++c)
+		titles.push_back("c" + std::to_string(c));
+	cdk::matrix table(s,{0,0},100000,20,6,"table",views(titles),
+	                  std::vector<int>(50,8),std::vector<EDisplayType>(50,vMIXED),true,{true,false});
+	for (std::size_t i = 0; i < static_cast<std::size_t>(state.range(0)); ++i)
+		table.setCell(i * 7919 % 100000,i % 50,"v" + std::to_string(i));
+	for (auto _ : state)
+	{
+		table.inject(KEY_NPAGE);
+		if (table.getRow() + 40 > table.rows())
+			table.moveToCell(0,0);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(matrix_page)->Arg(0)->Arg(10000)->Arg(1000000);
@@ -11,10 +11,43 @@ License:        MIT
 #include <cdk/cdk.h>
 
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
 #include <string_view>
 #include <vector>
+#include <deque>
 #include <algorithm>
+#include <numeric>
+#include <optional>
 #include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace cdk
 {
@@ -44,886 +77,6213 @@ StringList transformCharPtrPtr(char** str,int size)
 	return l;
 }
 
-struct widget
-{
-	void* _vptr{nullptr};
-	EObjectType type{vNULL};
-};
 /**
- * Screen object that manages its child widgets.
-*/
-class screen
+ * @brief NUL-terminated copy of a StringList in the char* array form libcdk expects.
+ * Unlike transformStringList it does not assume the views are NUL-terminated.
+ * Short lists are marshalled into storage inside the object itself, longer ones
+ * into a per-thread scratch buffer that keeps its capacity between calls, so
+ * repeated updates do not allocate once the buffer has grown.
+ * Meant to be used as a temporary for the duration of a libcdk call.
+ */
+class cstring_list
 {
-	struct deleter
+	static constexpr std::size_t inline_items = 16;
+	static constexpr std::size_t inline_chars = 512;
+
+	struct scratch
 	{
-		void operator ()(CDKSCREEN* p)
-		{
-			destroyCDKScreen(p);
-		}
+		std::vector<char*> items;
+		std::vector<char> chars;
+		bool busy{false};
 	};
-
-	using screenptr = std::unique_ptr<CDKSCREEN,deleter>;
-	screenptr _ptr;
-	static bool atexit_installed;
-	friend class label;
-	friend class button;
-	friend class text_entry;
-	friend class alpha_list;
-	friend class calendar;
-public:
-	/**
-	 * Constructor.
-	 * Creates an object in a curses WINDOW,
-	 * you can pass initscr() to use the full
-	 * terminal. It calls initCDKScreen and
-	 * install an atexit handler
-	*/
-	screen(WINDOW *cursesWindow)
+	static scratch& threadScratch()
 	{
-		_ptr = screenptr(initCDKScreen(cursesWindow));
-		initCDKColor();
-		if (!atexit_installed){
-			atexit(endCDK);
-			atexit_installed = true;
-		}
-
+		thread_local scratch s;
+		return s;
 	}
-	/**
-	 * Erase screen.
-	 * Erases all of the widgets which
-	 * are currently associated to the given screen.
-	 * This does NOT destroy the widgets.
-	*/
-	void erase()
+
+	char* _inlineItems[inline_items];
+	char _inlineChars[inline_chars];
+	scratch* _scratch{nullptr};
+	std::unique_ptr<scratch> _nested;
+	char** _items{_inlineItems};
+	int _size{0};
+
+	scratch& leaseScratch()
 	{
-		eraseCDKScreen(_ptr.get());
+		if (!_scratch)
+		{
+			scratch& s = threadScratch();
+			if (s.busy)
+			{
+				//another cstring_list on this thread holds it
+				_nested = std::make_unique<scratch>();
+				_scratch = _nested.get();
+			}
+			else
+			{
+				s.busy = true;
+				_scratch = &s;
+			}
+		}
+		return *_scratch;
 	}
-	/**
-	 * Redraws all of the widgets
-	 * which are currently associated
-	 * to this screenobject.
-	*/
-	void refresh()
+public:
+	explicit cstring_list(const StringList& list)
 	{
-		refreshCDKScreen(_ptr.get());
+		std::size_t chars = 0;
+		for (auto s : list)
+			chars += s.size() + 1;
+
+		char* out = _inlineChars;
+		if (chars > inline_chars)
+		{
+			auto& buffer = leaseScratch().chars;
+			if (buffer.size() < chars)
+				buffer.resize(chars);
+			out = buffer.data();
+		}
+		if (list.size() > inline_items)
+		{
+			auto& items = leaseScratch().items;
+			if (items.size() < list.size())
+				items.resize(list.size());
+			_items = items.data();
+		}
+		for (auto s : list)
+		{
+			std::copy(s.begin(),s.end(),out);
+			out[s.size()] = '\0';
+			_items[_size++] = out;
+			out += s.size() + 1;
+		}
 	}
 	/**
-	 * @brief lowerObject.
-	 * Has the opposite effect of the raiseCDKObject function call.
-	 * @param w pointer to widget
+	 * @brief Points at the strings of list instead of copying them,
+	 * list must outlive this object.
 	 */
-	static void lowerObject(widget& w)
+	explicit cstring_list(const std::vector<std::string>& list)
 	{
-		lowerCDKObject(w.type,w._vptr);
+		if (list.size() > inline_items)
+		{
+			auto& items = leaseScratch().items;
+			if (items.size() < list.size())
+				items.resize(list.size());
+			_items = items.data();
+		}
+		for (auto& s : list)
+			_items[_size++] = const_cast<char*>(s.c_str());
 	}
-	/**
-	 * @brief raiseObject.
-	 * raises the widget to the top of the screen.
-	 * If there are any widgets which overlap the given object
-	 * when a refresh is done, calling this function has the
-	 * effect of raising the object so no other widgets obstruct it.
-	 * @param w pointer to the object
-	 */
-	static void raiseObject(widget& w)
+	cstring_list(const cstring_list&) = delete;
+	cstring_list& operator=(const cstring_list&) = delete;
+	~cstring_list()
 	{
-		raiseCDKObject(w.type,w._vptr);
+		if (_scratch && !_nested)
+			_scratch->busy = false;
 	}
 	/**
-	 * @brief registerObject.
-	 * Is called automatically when a widget is created.
-	 * If for some reason an object does get unregistered,
-	 * by calling unregisterObject,
-	 * the widget can be registered again by calling this function.
+	 * @brief Array of size() NUL-terminated strings, valid while this object lives.
 	 */
-	void registerObject(widget& w)
+	char** data()
 	{
-		registerCDKObject(_ptr.get(),w.type,w._vptr);
+		return _items;
 	}
-	/**
-	 * @brief unregisterObject.
-	 * removes  the  widget  from  the screen.
-	 * This does NOT destroy the object,
-	 * it removes the widget from any further
-	 * refreshes by the function refresh.
-	 */
-	static void unregisterObject(widget& w)
+	int size() const
 	{
-		unregisterCDKObject(w.type,w._vptr);
+		return _size;
 	}
-
 };
-bool screen::atexit_installed=false;
 
 /**
- * @brief The point struct. Used to pass position on the screen.
+ * @brief Owning arena of NUL-terminated strings.
+ * Strings are copied next to each other into large blocks that never
+ * move, so the views returned stay valid until clear() or the pool's
+ * destruction, which free all the blocks at once.
  */
-struct point
-{
-	/**
-	 * @brief Position in x axis. May be an integer or one of the pre-defined values TOP, BOTTOM, and CENTER.
-	 */
-	int x;
-	/**
-	 * @brief Position in x axis. May be an integer or one of the pre-defined values LEFT, RIGHT, and CENTER.
-	 */
-	int y;
-};
-
-struct widget_size
+class string_pool
 {
-	int width;
-	int height;
-};
+	std::vector<std::unique_ptr<char[]>> _blocks;
+	std::vector<std::vector<std::string>> _adopted;
+	char* _next{nullptr};
+	std::size_t _left{0};
+	std::size_t _blockSize;
+	std::size_t _used{0};
+public:
+	static constexpr std::size_t default_block_size = 64 * 1024;
 
-/**
- * @brief Options passed to draw functions.
- */
-struct drawing_options
-{
-	/**
-	 * @brief Whether to draw a box around the widget.
-	 */
-	bool box{false};
+	explicit string_pool(std::size_t blockSize = default_block_size):
+		_blockSize(std::max<std::size_t>(blockSize,1))
+	{}
 	/**
-	 * @brief Whether to draw a shadow around the widget.
+	 * @brief n contiguous uninitialized bytes owned by the pool.
+	 * Requests larger than the block size get a block of their own.
 	 */
-	bool shadow{false};
-};
-
-/**
- * @brief Options passed to move functions.
- */
-struct move_options
-{
-	bool relative{false};
-	bool refresh{false};
-};
-
-/**
- * A managed curses label widget.
-*/
-class label :public widget
-{
-	struct deleter
+	char* allocate(std::size_t n)
 	{
-		void operator()(CDKLABEL* p)
+		if (n > _left)
 		{
-			destroyCDKLabel(p);
+			if (n > _blockSize)
+			{
+				_blocks.emplace_back(new char[n]);
+				_used += n;
+				return _blocks.back().get();
+			}
+			_blocks.emplace_back(new char[_blockSize]);
+			_next = _blocks.back().get();
+			_left = _blockSize;
 		}
-	};
-	using labelptr = std::unique_ptr<CDKLABEL,deleter>;
-	labelptr _ptr;
-public:
-	/**
-	 * @brief Default constructor.
-	 * Creates an empty object, dont call
-	 * member functions without assigning
-	 * an initialized object
-	*/
-	label() = default;
-
-	label(screen& parent,point p,StringList message, drawing_options opt)
-	{
-		auto v = transformStringList(message);
-		_ptr = labelptr(newCDKLabel(parent._ptr.get(),
-									p.x,p.y,
-									v.data(),v.size(),
-									opt.box,opt.shadow));
-		_vptr = _ptr.get();
+		char* p = _next;
+		_next += n;
+		_left -= n;
+		_used += n;
+		return p;
 	}
 	/**
-	 * @brief Draws the label widget on the screen.
-	 * @param box if true, the widget is drawn with a box.
-	*/
-	void draw(boolean box=false)
+	 * @brief Copies s into the pool.
+	 * @return a view of the copy, its data() is NUL-terminated.
+	 */
+	std::string_view add(std::string_view s)
 	{
-		drawCDKLabel(_ptr.get(),box);
+		char* p = allocate(s.size() + 1);
+		if (!s.empty())
+			std::memcpy(p,s.data(),s.size());
+		p[s.size()] = '\0';
+		return {p,s.size()};
 	}
 	/**
-	 * @brief Removes the widget from the screen.  This does NOT destroy the widget.
-	*/
-	void erase()
+	 * @brief Takes ownership of strings without copying their characters.
+	 * The strings are never touched again, so their buffers, including
+	 * those short enough to live inside the string objects, stay put.
+	 * @return views of the strings, in order, their data() is NUL-terminated.
+	 */
+	StringList adopt(std::vector<std::string>&& strings)
 	{
-		eraseCDKLabel(_ptr.get());
+		StringList views;
+		views.reserve(strings.size());
+		for (auto& item : strings)
+		{
+			views.emplace_back(item);
+			_used += item.size() + 1;
+		}
+		_adopted.push_back(std::move(strings));
+		return views;
 	}
 	/**
-	 * @brief Returns true if the widget will be drawn with a box around it.
-	*/
-	bool getBox()
+	 * @brief Bytes handed out or adopted since the last clear, terminators included.
+	 */
+	std::size_t bytesUsed() const
 	{
-		return getCDKLabelBox(_ptr.get());
+		return _used;
 	}
 	/**
-	 * @brief Returns the contents of the label widget.
-	*/
-	StringList getMessage()
+	 * @brief Frees every string, invalidating all the views.
+	 */
+	void clear()
 	{
-		StringList v;
-		int linesCount=0;
-		auto msg = getCDKLabelMessage(_ptr.get(),&linesCount);
-		for(int i = 0 ; i< linesCount; ++i)
-		{
-			v.push_back(reinterpret_cast<char*>(msg[i]));
-		}
-		return v;
+		_blocks.clear();
+		_adopted.clear();
+		_next = nullptr;
+		_left = 0;
+		_used = 0;
 	}
-	/**
-	 * @brief moves the widget to the given point.
-	 * @param p The parameters p.x and p.y are the new position of the widget.
+};
 
-				- The parameter p.x may be an integer or one of the pre-defined values TOP, BOTTOM, and CENTER.
+/**
+ * @brief Non-owning view of one line of libcdk chtype text.
+ * Each element packs a character with its curses attributes,
+ * they are decoded only when asked for.
+ */
+class chtype_line
+{
+	const chtype* _data{nullptr};
+	int _size{0};
+public:
+	using iterator = const chtype*;
 
-				- The parameter p.y may be an integer or one of the pre-defined values LEFT, RIGHT, and CENTER.
-	 * @param o The parameter o.relative states whether the p.x/p.y pair is a relative move or an absolute move.
-	*/
-	void move(point p,move_options o)
-	{
-		moveCDKLabel(_ptr.get(),
-					 p.x,p.y,
-					 o.relative,o.refresh);
-	}
-	/**
-	 * @brief Allows the user to move the widget around the screen
-	 * via the cursor/keypad keys.
-	 * @sa cdk_position (3) for key bindings.
-	*/
-	void position()
+	chtype_line() = default;
+	chtype_line(const chtype* data,int size):_data(data),_size(size)
+	{}
+	iterator begin() const
 	{
-		positionCDKLabel(_ptr.get());
+		return _data;
 	}
-	/**
-	 * @brief Allows the user to change the contents of the label widget.
-	 * The parameters are the same as the newCDKLabel.
-	*/
-	void set(StringList message,bool box)
+	iterator end() const
 	{
-		auto v = transformStringList(message);
-		setCDKLabel(_ptr.get(),
-					v.data(),v.size(),
-					box);
+		return _data + _size;
 	}
-	/**
-	 * @brief  Sets the background attribute of the widget.
-	 * @param attribute is a curses attribute,
-	 * e.g., A_BOLD.
-	*/
-	void setBackgroundAttrib(chtype attribute)
+	int size() const
 	{
-		setCDKLabelBackgroundAttrib(_ptr.get(),attribute);
+		return _size;
 	}
-	/**
-	 * @brief Sets the background color of the widget.
-	 * @param color is in the format of the Cdk format strings.
-	 * For more information see cdk_display (3).
-	*/
-	void setBackgroundColor(const char * color)
+	bool empty() const
 	{
-		setCDKLabelBackgroundColor(_ptr.get(),color);
+		return _size == 0;
 	}
-	/**
-	 * @brief Sets whether the widget will be drawn with a box around it.
-	*/
-	void setBox(bool box)
+	chtype operator[](int i) const
 	{
-		setCDKLabelBox(_ptr.get(),box);
+		return _data[i];
 	}
 	/**
-	 * @brief Sets the attribute of the box.
-	*/
-	void setBoxAttribute(chtype character)
+	 * @brief The character at i without its attributes.
+	 */
+	char charAt(int i) const
 	{
-		setCDKLabelBoxAttribute(_ptr.get(),character);
+		return static_cast<char>(_data[i] & A_CHARTEXT);
 	}
 	/**
-	 * @brief Sets the horizontal drawing character for the box to the given character.
-	*/
-	void setHorizontalChar(chtype character)
+	 * @brief The curses attributes at i, e.g. A_BOLD.
+	 */
+	chtype attributesAt(int i) const
 	{
-		setCDKLabelHorizontalChar(_ptr.get(),character);
+		return _data[i] & A_ATTRIBUTES;
 	}
 	/**
-	 * @brief Sets the lower left hand corner of the widget's box to the given character.
-	*/
-	void setLLChar(chtype character)
+	 * @brief Compares the characters of the line with text, ignoring attributes.
+	 */
+	bool equals(std::string_view text) const
 	{
-		setCDKLabelLLChar(_ptr.get(),character);
+		if (text.size() != static_cast<std::size_t>(_size))
+			return false;
+		for (int i = 0; i < _size; ++i)
+		{
+			if (charAt(i) != text[i])
+				return false;
+		}
+		return true;
 	}
 	/**
-	 * @brief Sets the lower right hand corner of the widget's box to the given character.
-	*/
-	void setLRChar(chtype character)
+	 * @brief Copies the characters of the line into a string.
+	 */
+	std::string str() const
 	{
-		setCDKLabelLRChar(_ptr.get(),character);
+		std::string text(static_cast<std::size_t>(_size),'\0');
+		for (int i = 0; i < _size; ++i)
+			text[i] = charAt(i);
+		return text;
 	}
+};
+
+/**
+ * @brief Non-owning view of the lines of a widget's chtype text,
+ * invalidated when the widget's contents change.
+ */
+class chtype_lines
+{
+	chtype* const* _lines{nullptr};
+	const int* _lengths{nullptr};
+	int _count{0};
+
+	static chtype_line lineAt(chtype* const* lines,const int* lengths,int i)
+	{
+		const chtype* line = lines[i];
+		int length = 0;
+		if (lengths)
+			length = lengths[i];
+		else if (line)
+			while (line[length])
+				++length;
+		return {line,length};
+	}
+public:
 	/**
-	 * @brief This sets the contents of the label widget.
-	*/
-	void setMessage(StringList message)
+	 * @brief Refers to the widget's lines directly, so it stays valid
+	 * after the chtype_lines it came from is gone, e.g. when iterating
+	 * getMessage().begin(), until the widget's contents change.
+	 */
+	class iterator
+	{
+		chtype* const* _lines{nullptr};
+		const int* _lengths{nullptr};
+		int _i{0};
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = chtype_line;
+		using difference_type = int;
+		using pointer = void;
+		using reference = chtype_line;
+
+		iterator() = default;
+		iterator(chtype* const* lines,const int* lengths,int i):_lines(lines),_lengths(lengths),_i(i)
+		{}
+		chtype_line operator*() const
+		{
+			return lineAt(_lines,_lengths,_i);
+		}
+		chtype_line operator[](int n) const
+		{
+			return lineAt(_lines,_lengths,_i + n);
+		}
+		iterator& operator++()
+		{
+			++_i;
+			return *this;
+		}
+		iterator operator++(int)
+		{
+			iterator it = *this;
+			++_i;
+			return it;
+		}
+		iterator& operator--()
+		{
+			--_i;
+			return *this;
+		}
+		iterator operator--(int)
+		{
+			iterator it = *this;
+			--_i;
+			return it;
+		}
+		iterator& operator+=(int n)
+		{
+			_i += n;
+			return *this;
+		}
+		iterator& operator-=(int n)
+		{
+			_i -= n;
+			return *this;
+		}
+		iterator operator+(int n) const
+		{
+			return {_lines,_lengths,_i + n};
+		}
+		friend iterator operator+(int n,const iterator& it)
+		{
+			return it + n;
+		}
+		iterator operator-(int n) const
+		{
+			return {_lines,_lengths,_i - n};
+		}
+		int operator-(const iterator& it) const
+		{
+			return _i - it._i;
+		}
+		bool operator==(const iterator& it) const
+		{
+			return _i == it._i;
+		}
+		bool operator!=(const iterator& it) const
+		{
+			return _i != it._i;
+		}
+		bool operator<(const iterator& it) const
+		{
+			return _i < it._i;
+		}
+		bool operator>(const iterator& it) const
+		{
+			return _i > it._i;
+		}
+		bool operator<=(const iterator& it) const
+		{
+			return _i <= it._i;
+		}
+		bool operator>=(const iterator& it) const
+		{
+			return _i >= it._i;
+		}
+	};
+
+	chtype_lines() = default;
+	/**
+	 * @param lines array of count lines.
+	 * @param lengths length of each line, if null lines are 0 terminated.
+	 */
+	chtype_lines(chtype* const* lines,const int* lengths,int count):
+		_lines(lines),_lengths(lengths),_count(count)
+	{}
+	iterator begin() const
 	{
-		auto v = transformStringList(message);
-		setCDKLabelMessage(_ptr.get(),
-						   v.data(),v.size());
+		return {_lines,_lengths,0};
+	}
+	iterator end() const
+	{
+		return {_lines,_lengths,_count};
+	}
+	int size() const
+	{
+		return _count;
+	}
+	bool empty() const
+	{
+		return _count == 0;
+	}
+	chtype_line operator[](int i) const
+	{
+		return lineAt(_lines,_lengths,i);
+	}
+};
+
+class screen;
+class render_scheduler;
+class widget_registry;
+
+struct widget
+{
+	void* _vptr{nullptr};
+	screen* _screen{nullptr};
+
+	widget() = default;
+	widget(const widget&) = default;
+	widget& operator=(const widget&) = default;
+	widget(widget&& other) noexcept
+		:_vptr(std::exchange(other._vptr,nullptr)),_screen(other._screen)
+	{}
+	widget& operator=(widget&& other) noexcept;
+	/**
+	 * @brief Drops the widget from the screen's dirty list, so a
+	 * widget later created at the same address is not redrawn by it.
+	 */
+	~widget();
+	/**
+	 * @brief Marks the widget as changed so the next
+	 * screen::refreshDirty redraws it.
+	 * Called by the setters that change what the widget shows.
+	 */
+	void touch();
+	/**
+	 * @brief Queues a redraw with the screen's render_scheduler.
+	 * @return false if no scheduler is attached and the caller
+	 * should draw immediately.
+	 */
+	bool defer();
+	/**
+	 * @brief defer for draw(box), the box is kept for the redraw.
+	 */
+	bool defer(bool box);
+};
+
+/**
+ * @brief Base of the widget wrappers, tags them with the type of
+ * the libcdk object they wrap.
+ * The type is a compile time constant, so the screen functions that
+ * need it take the wrapper's own type and store nothing per object.
+ */
+template<EObjectType T>
+struct basic_widget : widget
+{
+	static constexpr EObjectType object_type = T;
+};
+
+/**
+ * @brief Widget updates posted from any thread, applied by the UI thread.
+ * Producers push onto a lock-free list, the UI thread takes the whole
+ * list at once in drain. Updates with the same key (target widget,
+ * kind and detail) posted before a drain are coalesced so only the
+ * last one is applied. Posting also writes to a pipe, see wakeFd,
+ * so an event_loop waiting in poll wakes up.
+ */
+class update_queue
+{
+	struct key
+	{
+		const void* target;
+		int kind;
+		long detail;
+		bool operator<(const key& k) const
+		{
+			if (target != k.target)
+				return std::less<const void*>()(target,k.target);
+			if (kind != k.kind)
+				return kind < k.kind;
+			return detail < k.detail;
+		}
+		bool operator==(const key& k) const
+		{
+			return target == k.target && kind == k.kind && detail == k.detail;
+		}
+	};
+	struct node
+	{
+		node* next;
+		key k;
+		std::function<void()> apply;
+		bool cancelled{false};
+	};
+	std::atomic<node*> _head{nullptr};
+	int _pipe[2]{-1,-1};
+	std::vector<node*> _batch;
+	std::vector<std::size_t> _order;
+public:
+	/**
+	 * @brief Update kinds used by the widgets' post functions.
+	 */
+	enum kind
+	{
+		custom,
+		message,
+		value,
+		marker
+	};
+	update_queue()
+	{
+		if (::pipe(_pipe) == 0)
+		{
+			for (int fd : _pipe)
+				fcntl(fd,F_SETFL,fcntl(fd,F_GETFL) | O_NONBLOCK);
+		}
+	}
+	update_queue(const update_queue&) = delete;
+	update_queue& operator=(const update_queue&) = delete;
+	~update_queue()
+	{
+		node* n = _head.exchange(nullptr);
+		while (n)
+		{
+			node* next = n->next;
+			delete n;
+			n = next;
+		}
+		for (int fd : _pipe)
+		{
+			if (fd >= 0)
+				::close(fd);
+		}
 	}
 	/**
-	 * @brief Sets the upper left hand corner of the widget's box to the given character.
+	 * @brief Posts fn to be called by the next drain, thread-safe.
+	 * A previous undrained update with the same target, kind and detail
+	 * is dropped. A null target is never coalesced.
+	 */
+	void post(const void* target,int kind,long detail,std::function<void()> fn)
+	{
+		node* n = new node{nullptr,{target,kind,detail},std::move(fn)};
+		node* head = _head.load(std::memory_order_relaxed);
+		do
+		{
+			n->next = head;
+		}
+		while (!_head.compare_exchange_weak(head,n,
+		                                    std::memory_order_release,
+		                                    std::memory_order_relaxed));
+		if (!head && _pipe[1] >= 0)
+		{
+			char c = 0;
+			[[maybe_unused]] auto r = ::write(_pipe[1],&c,1);
+		}
+	}
+	/**
+	 * @brief Posts fn without coalescing, thread-safe.
+	 */
+	void post(std::function<void()> fn)
+	{
+		post(nullptr,custom,0,std::move(fn));
+	}
+	bool empty() const
+	{
+		return _head.load(std::memory_order_relaxed) == nullptr;
+	}
+	/**
+	 * @brief Descriptor that becomes readable when updates are posted.
+	 */
+	int wakeFd() const
+	{
+		return _pipe[0];
+	}
+	/**
+	 * @brief Applies the pending updates in the order they were posted.
+	 * Must be called from the UI thread.
+	 * @return the number of updates applied.
+	 */
+	std::size_t drain()
+	{
+		if (_pipe[0] >= 0)
+		{
+			char buf[64];
+			while (::read(_pipe[0],buf,sizeof buf) > 0)
+				;
+		}
+		node* n = _head.exchange(nullptr,std::memory_order_acquire);
+		if (!n)
+			return 0;
+		_batch.clear();
+		for (; n; n = n->next)
+			_batch.push_back(n);
+		std::reverse(_batch.begin(),_batch.end());
+
+		//keep only the last update of each key
+		_order.resize(_batch.size());
+		for (std::size_t i = 0; i < _order.size(); ++i)
+			_order[i] = i;
+		std::stable_sort(_order.begin(),_order.end(),[this](std::size_t a,std::size_t b){
+			return _batch[a]->k < _batch[b]->k;
+		});
+		for (std::size_t i = 0; i + 1 < _order.size(); ++i)
+		{
+			node* cur = _batch[_order[i]];
+			if (cur->k.target && cur->k == _batch[_order[i + 1]]->k)
+				cur->apply = nullptr;
+		}
+		std::size_t applied = 0;
+		for (std::size_t i = 0; i < _batch.size(); ++i)
+		{
+			node* b = _batch[i];
+			if (b->apply && !b->cancelled)
+			{
+				b->apply();
+				++applied;
+			}
+			delete b;
+			_batch[i] = nullptr;
+		}
+		_batch.clear();
+		return applied;
+	}
+	/**
+	 * @brief Drops the pending updates of target.
+	 * Must be called from the UI thread, widgets call it when they
+	 * are destroyed, also from an update being applied.
+	 */
+	void cancel(const void* target)
+	{
+		if (!target)
+			return;
+		for (node* n = _head.load(std::memory_order_acquire); n; n = n->next)
+		{
+			if (n->k.target == target)
+				n->cancelled = true;
+		}
+		for (node* b : _batch)
+		{
+			if (b && b->k.target == target)
+				b->cancelled = true;
+		}
+	}
+};
+
+/**
+ * Screen object that manages its child widgets.
+*/
+class screen
+{
+	struct deleter
+	{
+		void operator ()(CDKSCREEN* p)
+		{
+			destroyCDKScreen(p);
+		}
+	};
+
+	using screenptr = std::unique_ptr<CDKSCREEN,deleter>;
+	screenptr _ptr;
+	struct dirty_entry
+	{
+		CDKOBJS* obj;
+		/**
+		 * Box asked for by a deferred draw, -1 to use the widget's own.
+		 */
+		int box;
+	};
+	std::vector<dirty_entry> _dirty;
+	render_scheduler* _scheduler{nullptr};
+	update_queue _updates;
+	struct registry_deleter
+	{
+		void operator()(widget_registry* r) const;
+	};
+	/**
+	 * Created on first use. Declared after _ptr so the widgets are
+	 * destroyed before the CDKSCREEN.
+	 */
+	std::unique_ptr<widget_registry,registry_deleter> _widgets;
+	static bool atexit_installed;
+
+	void markObject(void* p)
+	{
+		auto obj = static_cast<CDKOBJS*>(p);
+		if (obj && !findDirty(obj))
+			_dirty.push_back({obj,-1});
+	}
+	dirty_entry* findDirty(CDKOBJS* obj)
+	{
+		auto it = std::find_if(_dirty.begin(),_dirty.end(),[obj](const dirty_entry& e){
+			return e.obj == obj;
+		});
+		return it == _dirty.end() ? nullptr : &*it;
+	}
+	friend class render_scheduler;
+	friend class label;
+	friend class button;
+	friend class text_entry;
+	friend class alpha_list;
+	friend class virtual_alpha_list;
+	friend class scroll_list;
+	friend class log_viewer;
+	friend class scrolling_window;
+	friend class file_viewer;
+	friend class matrix;
+	friend class calendar;
+public:
+	/**
+	 * Constructor.
+	 * Creates an object in a curses WINDOW,
+	 * you can pass initscr() to use the full
+	 * terminal. It calls initCDKScreen and
+	 * install an atexit handler
 	*/
-	void setULChar(chtype character)
+	screen(WINDOW *cursesWindow)
 	{
-		setCDKLabelULChar(_ptr.get(),character);
+		_ptr = screenptr(initCDKScreen(cursesWindow));
+		initCDKColor();
+		if (!atexit_installed){
+			atexit(endCDK);
+			atexit_installed = true;
+		}
+
 	}
+	///widgets keep a pointer to the screen they were created in
+	screen(screen&&) = delete;
+	screen& operator=(screen&&) = delete;
 	/**
-	 * @brief Sets the upper right hand corner of the widget's box to the given character.
+	 * Erase screen.
+	 * Erases all of the widgets which
+	 * are currently associated to the given screen.
+	 * This does NOT destroy the widgets.
 	*/
-	void setURChar(chtype character)
+	void erase()
 	{
-		setCDKLabelURChar(_ptr.get(),character);
+		eraseCDKScreen(_ptr.get());
 	}
 	/**
-	 * @brief Sets the vertical drawing character for the box to the given character.
+	 * Redraws all of the widgets
+	 * which are currently associated
+	 * to this screenobject.
 	*/
-	void setVerticalChar(chtype character)
+	void refresh()
+	{
+		_updates.drain();
+		refreshCDKScreen(_ptr.get());
+		_dirty.clear();
+	}
+	/**
+	 * @brief Flags a widget to be redrawn by refreshDirty.
+	 * Setters do this automatically, call it after changing
+	 * a widget by other means, e.g. inject.
+	 */
+	void markDirty(widget& w)
+	{
+		markObject(w._vptr);
+	}
+	/**
+	 * @brief Flags a widget to be redrawn by refreshDirty with or
+	 * without a box, as a deferred draw(box) asked.
+	 */
+	void markDirty(widget& w,bool box)
+	{
+		auto obj = static_cast<CDKOBJS*>(w._vptr);
+		if (!obj)
+			return;
+		if (dirty_entry* e = findDirty(obj))
+			e->box = box;
+		else
+			_dirty.push_back({obj,box});
+	}
+	/**
+	 * @brief Stops refreshDirty from redrawing w.
+	 * Called when w is destroyed or unregistered.
+	 */
+	void forget(widget& w)
+	{
+		if (dirty_entry* e = findDirty(static_cast<CDKOBJS*>(w._vptr)))
+			_dirty.erase(_dirty.begin() + (e - _dirty.data()));
+	}
+	/**
+	 * @brief Redraws only the widgets changed since the last refresh.
+	 * Widgets are drawn in stacking order, with the box asked for by a
+	 * deferred draw. libcdk's draw functions refresh their own windows,
+	 * so each redrawn widget reaches the terminal separately. Widgets
+	 * overlapping a changed one are not redrawn, use refresh when the
+	 * layout overlaps.
+	 */
+	void refreshDirty()
+	{
+		_updates.drain();
+		if (_dirty.empty())
+			return;
+		CDKSCREEN* s = _ptr.get();
+		for (int i = 0; i < s->objectCount; ++i)
+		{
+			CDKOBJS* obj = s->object[i];
+			dirty_entry* e = obj && obj->isVisible ? findDirty(obj) : nullptr;
+			if (e)
+				obj->fn->drawObj(obj,e->box < 0 ? obj->box : e->box != 0);
+		}
+		_dirty.clear();
+	}
+	/**
+	 * @brief The curses window this screen was created in.
+	 */
+	WINDOW* window()
+	{
+		return _ptr->window;
+	}
+	/**
+	 * @brief Queue of updates posted from other threads,
+	 * drained before every refresh.
+	 */
+	update_queue& updates()
+	{
+		return _updates;
+	}
+	/**
+	 * @brief Widgets owned by the screen, destroyed with it.
+	 */
+	widget_registry& widgets();
+	/**
+	 * @brief Whether any widget is waiting for refreshDirty.
+	 */
+	bool dirty() const
+	{
+		return !_dirty.empty();
+	}
+	/**
+	 * @brief The render_scheduler attached to this screen, if any.
+	 */
+	render_scheduler* scheduler()
+	{
+		return _scheduler;
+	}
+	/**
+	 * @brief lowerObject.
+	 * Has the opposite effect of the raiseCDKObject function call.
+	 * @param w pointer to widget
+	 */
+	template<class W>
+	static void lowerObject(W& w)
+	{
+		lowerCDKObject(W::object_type,w._vptr);
+	}
+	/**
+	 * @brief raiseObject.
+	 * raises the widget to the top of the screen.
+	 * If there are any widgets which overlap the given object
+	 * when a refresh is done, calling this function has the
+	 * effect of raising the object so no other widgets obstruct it.
+	 * @param w pointer to the object
+	 */
+	template<class W>
+	static void raiseObject(W& w)
+	{
+		raiseCDKObject(W::object_type,w._vptr);
+	}
+	/**
+	 * @brief registerObject.
+	 * Is called automatically when a widget is created.
+	 * If for some reason an object does get unregistered,
+	 * by calling unregisterObject,
+	 * the widget can be registered again by calling this function.
+	 */
+	template<class W>
+	void registerObject(W& w)
+	{
+		registerCDKObject(_ptr.get(),W::object_type,w._vptr);
+	}
+	/**
+	 * @brief unregisterObject.
+	 * removes  the  widget  from  the screen.
+	 * This does NOT destroy the object,
+	 * it removes the widget from any further
+	 * refreshes by the function refresh.
+	 */
+	template<class W>
+	static void unregisterObject(W& w)
+	{
+		if (w._screen)
+			w._screen->forget(w);
+		unregisterCDKObject(W::object_type,w._vptr);
+	}
+
+};
+bool screen::atexit_installed=false;
+
+/**
+ * @brief Coalesces redraws of a screen into frames.
+ * While attached, widget draw() calls and moves with
+ * move_options::refresh only queue the widget, poll then
+ * redraws everything queued at most once per frame interval.
+ * A widget changed several times in a frame is drawn once, but
+ * each widget drawn still costs its own terminal write.
+ */
+class render_scheduler
+{
+	using clock = std::chrono::steady_clock;
+	screen& _screen;
+	clock::duration _interval;
+	clock::time_point _lastFrame{};
+	bool _pending{false};
+	bool _full{false};
+public:
+	/**
+	 * @brief Attaches a scheduler to s, it must outlive the scheduler.
+	 * @param fps maximum number of frames flushed per second.
+	 */
+	explicit render_scheduler(screen& s,int fps=30):_screen(s)
+	{
+		setFps(fps);
+		_screen._scheduler = this;
+	}
+	render_scheduler(const render_scheduler&) = delete;
+	render_scheduler& operator=(const render_scheduler&) = delete;
+	~render_scheduler()
+	{
+		if (_screen._scheduler == this)
+			_screen._scheduler = nullptr;
+	}
+	void setFps(int fps)
+	{
+		_interval = std::chrono::duration_cast<clock::duration>(
+		            std::chrono::seconds(1)) / std::max(fps,1);
+	}
+	/**
+	 * @brief Queues w to be redrawn on the next frame.
+	 */
+	void request(widget& w)
+	{
+		_screen.markDirty(w);
+		_pending = true;
+	}
+	/**
+	 * @brief Queues w to be redrawn on the next frame, with or without a box.
+	 */
+	void request(widget& w,bool box)
+	{
+		_screen.markDirty(w,box);
+		_pending = true;
+	}
+	/**
+	 * @brief Queues a full screen::refresh for the next frame.
+	 */
+	void requestRefresh()
+	{
+		_full = true;
+		_pending = true;
+	}
+	/**
+	 * @brief Whether a redraw was requested or a widget changed.
+	 */
+	bool pending() const
+	{
+		return _pending || _screen.dirty();
+	}
+	/**
+	 * @brief Time left until the next frame may be flushed,
+	 * zero if it may be flushed now.
+	 */
+	clock::duration timeUntilNextFrame() const
+	{
+		auto next = _lastFrame + _interval;
+		auto now = clock::now();
+		return next > now ? next - now : clock::duration::zero();
+	}
+	/**
+	 * @brief Flushes the queued redraws if a frame is due.
+	 * @return true if a frame was flushed.
+	 */
+	bool poll()
+	{
+		if (!pending() || timeUntilNextFrame() != clock::duration::zero())
+			return false;
+		flush();
+		return true;
+	}
+	/**
+	 * @brief Flushes the queued redraws now.
+	 */
+	void flush()
+	{
+		if (_full)
+			_screen.refresh();
+		else
+			_screen.refreshDirty();
+		_full = false;
+		_pending = false;
+		_lastFrame = clock::now();
+	}
+};
+
+/**
+ * @brief Non-blocking input loop for a screen.
+ * Waits with poll(2) on the keyboard and on any watched file
+ * descriptor, injects keys into the focused widget and redraws
+ * changed widgets after each round, through the screen's
+ * render_scheduler when one is attached.
+ */
+class event_loop
+{
+	struct watch_entry
+	{
+		std::function<void(int,short)> handler;
+		bool removed{false};
+	};
+	screen& _screen;
+	int _inputFd;
+	std::vector<pollfd> _fds;
+	/**
+	 * A deque so handlers that add watches do not move the one running.
+	 */
+	std::deque<watch_entry> _watches;
+	CDKOBJS* _focusObj{nullptr};
+	std::function<void(chtype)> _inject;
+	std::function<bool(chtype)> _keyHandler;
+	std::function<void(EExitType)> _exitHandler;
+	bool _quit{false};
+
+	WINDOW* inputWindow()
+	{
+		if (_focusObj && _focusObj->inputWindow)
+			return _focusObj->inputWindow;
+		return _screen.window();
+	}
+	void readKeys()
+	{
+		WINDOW* win = inputWindow();
+		keypad(win,TRUE);
+		nodelay(win,TRUE);
+		int c;
+		while (!_quit && (c = wgetch(win)) != ERR)
+		{
+			if (_keyHandler && _keyHandler(static_cast<chtype>(c)))
+				continue;
+			if (!_inject)
+				continue;
+			_inject(static_cast<chtype>(c));
+			if (_exitHandler && _focusObj
+			        && (_focusObj->exitType == vNORMAL || _focusObj->exitType == vESCAPE_HIT))
+			{
+				_exitHandler(_focusObj->exitType);
+			}
+		}
+		nodelay(win,FALSE);
+	}
+	void flush()
+	{
+		_screen.updates().drain();
+		if (auto sched = _screen.scheduler())
+			sched->poll();
+		else
+			_screen.refreshDirty();
+	}
+public:
+	/**
+	 * @param s the screen to redraw.
+	 * @param inputFd descriptor curses reads keys from.
+	 */
+	explicit event_loop(screen& s,int inputFd = STDIN_FILENO):
+		_screen(s),_inputFd(inputFd)
+	{
+		_fds.push_back({_inputFd,POLLIN,0});
+		_watches.emplace_back();
+		int wake = _screen.updates().wakeFd();
+		if (wake >= 0)
+			watch(wake,POLLIN,[](int,short){});
+	}
+	/**
+	 * @brief Calls handler(fd,revents) whenever poll reports events on fd.
+	 * @param events poll(2) event mask, e.g. POLLIN.
+	 */
+	void watch(int fd,short events,std::function<void(int,short)> handler)
+	{
+		_fds.push_back({fd,events,0});
+		_watches.push_back({std::move(handler)});
+	}
+	/**
+	 * @brief Stops watching fd, safe to call from a handler.
+	 */
+	void unwatch(int fd)
+	{
+		for (std::size_t i = 1; i < _fds.size(); ++i)
+		{
+			if (_fds[i].fd == fd)
+				_watches[i].removed = true;
+		}
+	}
+	/**
+	 * @brief Sends keys to w through its inject member function.
+	 * w must stay at the same address while it has the focus.
+	 */
+	template<class W>
+	void focus(W& w)
+	{
+		_focusObj = static_cast<CDKOBJS*>(w._vptr);
+		_inject = [&w](chtype c){ w.inject(c); };
+	}
+	/**
+	 * @brief Stops sending keys to any widget.
+	 */
+	void clearFocus()
+	{
+		_focusObj = nullptr;
+		_inject = nullptr;
+	}
+	/**
+	 * @brief Sees every key before the focused widget,
+	 * the key is not injected if the handler returns true.
+	 */
+	void setKeyHandler(std::function<bool(chtype)> handler)
+	{
+		_keyHandler = std::move(handler);
+	}
+	/**
+	 * @brief Called when an injected key makes the focused widget
+	 * exit with vNORMAL or vESCAPE_HIT.
+	 */
+	void setExitHandler(std::function<void(EExitType)> handler)
+	{
+		_exitHandler = std::move(handler);
+	}
+	/**
+	 * @brief Waits for input at most timeout, handles it and redraws.
+	 * A negative timeout waits until there is input, the wait is
+	 * shortened to the next frame when redraws are pending.
+	 * @return false if poll failed.
+	 */
+	bool runOnce(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1))
+	{
+		if (!_screen.updates().empty())
+			timeout = std::chrono::milliseconds(0);
+		if (auto sched = _screen.scheduler(); sched && sched->pending())
+		{
+			auto frame = std::chrono::ceil<std::chrono::milliseconds>(sched->timeUntilNextFrame());
+			if (timeout.count() < 0 || frame < timeout)
+				timeout = frame;
+		}
+		int n = ::poll(_fds.data(),_fds.size(),static_cast<int>(timeout.count()));
+		if (n < 0)
+			return errno == EINTR;
+		if (n > 0)
+		{
+			if (_fds[0].revents)
+				readKeys();
+			//handlers may add watches, only visit the ones polled
+			std::size_t count = _fds.size();
+			for (std::size_t i = 1; i < count && !_quit; ++i)
+			{
+				if (_fds[i].revents && !_watches[i].removed)
+					_watches[i].handler(_fds[i].fd,_fds[i].revents);
+			}
+		}
+		for (std::size_t i = _fds.size(); i-- > 1;)
+		{
+			if (_watches[i].removed)
+			{
+				_fds.erase(_fds.begin() + i);
+				_watches.erase(_watches.begin() + i);
+			}
+		}
+		flush();
+		return true;
+	}
+	/**
+	 * @brief Runs until quit is called, at once if it was called before.
+	 */
+	void run()
+	{
+		while (!_quit && runOnce())
+			;
+		_quit = false;
+	}
+	/**
+	 * @brief Makes run return after the current round,
+	 * remaining keys and handlers of the round are skipped.
+	 * The request is cleared when run returns.
+	 */
+	void quit()
+	{
+		_quit = true;
+	}
+};
+
+/**
+ * @brief curses terminal without a TTY, for tests and benchmarks.
+ * Output goes to an anonymous temporary file so its size can be
+ * measured, input comes from a pipe fed with sendKeys. Construct a
+ * screen on window() to run widgets on it:
+ * @code
+ * cdk::headless_terminal term(120,40);
+ * cdk::screen s(term.window());
+ * @endcode
+ */
+class headless_terminal
+{
+	FILE* _out{nullptr};
+	FILE* _in{nullptr};
+	int _keys{-1};
+	SCREEN* _term{nullptr};
+
+	void release()
+	{
+		if (_term)
+		{
+			set_term(_term);
+			endwin();
+			delscreen(_term);
+		}
+		if (_keys >= 0)
+			::close(_keys);
+		if (_in)
+			std::fclose(_in);
+		if (_out)
+			std::fclose(_out);
+	}
+public:
+	/**
+	 * @param columns terminal width.
+	 * @param lines terminal height.
+	 * @param termType terminfo entry describing the emulated terminal.
+	 */
+	explicit headless_terminal(int columns=80,int lines=24,const char* termType="xterm")
+	{
+		int fds[2];
+		_out = std::tmpfile();
+		if (!_out || ::pipe(fds) != 0)
+		{
+			release();
+			throw std::runtime_error("headless_terminal: cannot create streams");
+		}
+		_keys = fds[1];
+		_in = fdopen(fds[0],"r");
+		if (!_in)
+		{
+			::close(fds[0]);
+			release();
+			throw std::runtime_error("headless_terminal: cannot create streams");
+		}
+		_term = newterm(termType,_out,_in);
+		if (!_term)
+		{
+			release();
+			throw std::runtime_error("headless_terminal: unknown terminal type");
+		}
+		resizeterm(lines,columns);
+		//drop the KEY_RESIZE queued by resizeterm
+		flushinp();
+	}
+	headless_terminal(const headless_terminal&) = delete;
+	headless_terminal& operator=(const headless_terminal&) = delete;
+	~headless_terminal()
+	{
+		release();
+	}
+	/**
+	 * @brief The full-terminal window, pass it to screen.
+	 */
+	WINDOW* window()
+	{
+		set_term(_term);
+		return stdscr;
+	}
+	/**
+	 * @brief Bytes curses wrote to the terminal since construction
+	 * or the last clearOutput.
+	 */
+	std::size_t bytesWritten()
+	{
+		struct stat st;
+		if (fstat(fileno(_out),&st) != 0)
+			return 0;
+		return static_cast<std::size_t>(st.st_size);
+	}
+	/**
+	 * @brief The raw bytes written, including escape sequences.
+	 */
+	std::string output()
+	{
+		std::string out(bytesWritten(),'\0');
+		auto n = ::pread(fileno(_out),out.data(),out.size(),0);
+		out.resize(n > 0 ? static_cast<std::size_t>(n) : 0);
+		return out;
+	}
+	/**
+	 * @brief Discards the captured output.
+	 */
+	void clearOutput()
+	{
+		int fd = fileno(_out);
+		if (::ftruncate(fd,0) == 0)
+			::lseek(fd,0,SEEK_SET);
+	}
+	/**
+	 * @brief Text of one row as curses last displayed it, attributes stripped.
+	 */
+	std::string line(int row)
+	{
+		set_term(_term);
+		std::string text(static_cast<std::size_t>(COLS),' ');
+		for (int col = 0; col < COLS; ++col)
+			text[col] = static_cast<char>(mvwinch(curscr,row,col) & A_CHARTEXT);
+		return text;
+	}
+	/**
+	 * @brief Text of every row as curses last displayed it.
+	 */
+	std::vector<std::string> contents()
+	{
+		std::vector<std::string> rows;
+		set_term(_term);
+		for (int row = 0; row < LINES; ++row)
+			rows.push_back(line(row));
+		return rows;
+	}
+	/**
+	 * @brief Queues keys to be read by curses as if typed.
+	 */
+	void sendKeys(std::string_view keys)
+	{
+		while (!keys.empty())
+		{
+			auto n = ::write(_keys,keys.data(),keys.size());
+			if (n <= 0)
+				break;
+			keys.remove_prefix(static_cast<std::size_t>(n));
+		}
+	}
+	/**
+	 * @brief Descriptor curses reads keys from, pass it to event_loop.
+	 */
+	int inputFd() const
+	{
+		return fileno(_in);
+	}
+};
+
+inline void widget::touch()
+{
+	if (_screen)
+		_screen->markDirty(*this);
+}
+
+inline widget& widget::operator=(widget&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (_screen && _vptr)
+		{
+			_screen->forget(*this);
+			_screen->updates().cancel(_vptr);
+		}
+		_vptr = std::exchange(other._vptr,nullptr);
+		_screen = other._screen;
+	}
+	return *this;
+}
+
+inline widget::~widget()
+{
+	if (_screen && _vptr)
+	{
+		_screen->forget(*this);
+		_screen->updates().cancel(_vptr);
+	}
+}
+
+inline bool widget::defer()
+{
+	if (!_screen || !_screen->scheduler())
+		return false;
+	_screen->scheduler()->request(*this);
+	return true;
+}
+
+inline bool widget::defer(bool box)
+{
+	if (!_screen || !_screen->scheduler())
+		return false;
+	_screen->scheduler()->request(*this,box);
+	return true;
+}
+
+/**
+ * @brief The point struct. Used to pass position on the screen.
+ */
+struct point
+{
+	/**
+	 * @brief Position in x axis. May be an integer or one of the pre-defined values TOP, BOTTOM, and CENTER.
+	 */
+	int x;
+	/**
+	 * @brief Position in x axis. May be an integer or one of the pre-defined values LEFT, RIGHT, and CENTER.
+	 */
+	int y;
+};
+
+struct widget_size
+{
+	int width;
+	int height;
+};
+
+/**
+ * @brief Options passed to draw functions.
+ */
+struct drawing_options
+{
+	/**
+	 * @brief Whether to draw a box around the widget.
+	 */
+	bool box{false};
+	/**
+	 * @brief Whether to draw a shadow around the widget.
+	 */
+	bool shadow{false};
+};
+
+/**
+ * @brief Options passed to move functions.
+ */
+struct move_options
+{
+	bool relative{false};
+	/**
+	 * @brief Whether to redraw after moving. Deferred to the next frame
+	 * when the screen has a render_scheduler.
+	 */
+	bool refresh{false};
+};
+
+/**
+ * @brief Whether W is a widget wrapper with draw, erase and move.
+ */
+template<class W,class = void>
+struct is_drawable_widget : std::false_type
+{};
+template<class W>
+struct is_drawable_widget<W,std::void_t<
+        decltype(W::object_type),
+        decltype(std::declval<W&>().draw(true)),
+        decltype(std::declval<W&>().erase()),
+        decltype(std::declval<W&>().move(point{},move_options{}))>>
+	: std::is_base_of<widget,W>
+{};
+template<class W>
+inline constexpr bool is_drawable_widget_v = is_drawable_widget<W>::value;
+
+#ifdef __cpp_concepts
+/**
+ * @brief A widget wrapper with draw, erase and move.
+ */
+template<class W>
+concept drawable_widget = is_drawable_widget_v<W>;
+#endif
+
+/**
+ * @brief Owning handle to a widget of any type.
+ * Widgets of up to Capacity bytes are stored inside the handle,
+ * larger ones on the heap. Calls are dispatched through a table of
+ * plain function pointers generated for each widget type, there are
+ * no virtual functions. Widgets stored inside move with the handle,
+ * so they must not have the focus of an event_loop while the handle
+ * is moved, e.g. when a vector of handles grows.
+ */
+template<std::size_t Capacity>
+class basic_any_widget
+{
+	struct ops
+	{
+		EObjectType type;
+		widget* (*base)(void* storage);
+		void (*draw)(void* storage,bool box);
+		void (*erase)(void* storage);
+		void (*move)(void* storage,point p,move_options o);
+		void (*relocate)(void* from,void* to);
+		void (*destroy)(void* storage);
+	};
+	template<class W>
+	static constexpr bool stored_inline = sizeof(W) <= Capacity
+	        && alignof(W) <= alignof(std::max_align_t)
+	        && std::is_nothrow_move_constructible_v<W>;
+
+	template<class W>
+	static W* object(void* storage)
+	{
+		if constexpr (stored_inline<W>)
+			return std::launder(static_cast<W*>(storage));
+		else
+			return *static_cast<W**>(storage);
+	}
+	template<class W>
+	static const ops* opsFor()
+	{
+		static constexpr ops table{
+			W::object_type,
+			[](void* s) -> widget* { return object<W>(s); },
+			[](void* s,bool box){ object<W>(s)->draw(box); },
+			[](void* s){ object<W>(s)->erase(); },
+			[](void* s,point p,move_options o){ object<W>(s)->move(p,o); },
+			[](void* from,void* to){
+				if constexpr (stored_inline<W>)
+				{
+					::new (to) W(std::move(*object<W>(from)));
+					object<W>(from)->~W();
+				}
+				else
+					*static_cast<W**>(to) = object<W>(from);
+			},
+			[](void* s){
+				if constexpr (stored_inline<W>)
+					object<W>(s)->~W();
+				else
+					delete object<W>(s);
+			}
+		};
+		return &table;
+	}
+
+	alignas(std::max_align_t) unsigned char _storage[std::max(Capacity,sizeof(void*))];
+	const ops* _ops{nullptr};
+public:
+	basic_any_widget() = default;
+	/**
+	 * @brief Takes ownership of w.
+	 */
+	template<class W,std::enable_if_t<is_drawable_widget_v<W>,int> = 0>
+	basic_any_widget(W&& w)
+	{
+		emplace<W>(std::move(w));
+	}
+	basic_any_widget(basic_any_widget&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+	basic_any_widget& operator=(basic_any_widget&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			if (other._ops)
+			{
+				other._ops->relocate(other._storage,_storage);
+				_ops = std::exchange(other._ops,nullptr);
+			}
+		}
+		return *this;
+	}
+	~basic_any_widget()
+	{
+		reset();
+	}
+	/**
+	 * @brief Destroys the current widget and creates a W from args in its place.
+	 */
+	template<class W,class... Args>
+	W& emplace(Args&&... args)
+	{
+		static_assert(is_drawable_widget_v<W>,"W must be a widget wrapper");
+		reset();
+		if constexpr (stored_inline<W>)
+			::new (static_cast<void*>(_storage)) W(std::forward<Args>(args)...);
+		else
+			*reinterpret_cast<W**>(_storage) = new W(std::forward<Args>(args)...);
+		_ops = opsFor<W>();
+		return *object<W>(_storage);
+	}
+	/**
+	 * @brief Destroys the widget, leaving the handle empty.
+	 */
+	void reset()
+	{
+		if (_ops)
+			std::exchange(_ops,nullptr)->destroy(_storage);
+	}
+	explicit operator bool() const
+	{
+		return _ops != nullptr;
+	}
+	/**
+	 * @brief The libcdk type of the widget, vNULL if empty.
+	 */
+	EObjectType type() const
+	{
+		return _ops ? _ops->type : vNULL;
+	}
+	/**
+	 * @brief The widget if it is a W, otherwise nullptr.
+	 */
+	template<class W>
+	W* get()
+	{
+		return _ops == opsFor<W>() ? object<W>(_storage) : nullptr;
+	}
+	widget& base()
+	{
+		return *_ops->base(_storage);
+	}
+	void draw(bool box)
+	{
+		_ops->draw(_storage,box);
+	}
+	void erase()
+	{
+		_ops->erase(_storage);
+	}
+	void move(point p,move_options o)
+	{
+		_ops->move(_storage,p,o);
+	}
+};
+
+/**
+ * @brief any_widget storing the smaller wrappers inline.
+ */
+using any_widget = basic_any_widget<4 * sizeof(void*)>;
+
+/**
+ * @brief Refers to a widget owned by a widget_registry.
+ * Once the widget is removed the handle finds nothing, even after
+ * its slot is reused by another widget.
+ */
+struct widget_handle
+{
+	std::uint32_t index{~std::uint32_t{0}};
+	std::uint32_t generation{0};
+
+	friend bool operator==(widget_handle a,widget_handle b)
+	{
+		return a.index == b.index && a.generation == b.generation;
+	}
+	friend bool operator!=(widget_handle a,widget_handle b)
+	{
+		return !(a == b);
+	}
+};
+
+/**
+ * @brief Owns widgets of any type in one contiguous array.
+ * Handles are looked up in O(1) through a table of slots that
+ * count how many times they were reused, removing a widget moves
+ * the last one into its place so the array has no holes.
+ * Iteration visits the widgets in no particular order.
+ */
+class widget_registry
+{
+	static constexpr std::uint32_t none = ~std::uint32_t{0};
+	struct slot
+	{
+		/**
+		 * Position in _widgets, or the next free slot.
+		 */
+		std::uint32_t position;
+		std::uint32_t generation;
+	};
+	std::vector<any_widget> _widgets;
+	/**
+	 * Slot of each widget in _widgets.
+	 */
+	std::vector<std::uint32_t> _slotOf;
+	std::vector<slot> _slots;
+	std::uint32_t _free{none};
+
+	widget_handle insert(any_widget&& w)
+	{
+		if (_free == none)
+		{
+			_slots.push_back({none,0});
+			_free = static_cast<std::uint32_t>(_slots.size() - 1);
+		}
+		std::uint32_t index = _free;
+		_widgets.push_back(std::move(w));
+		try
+		{
+			_slotOf.push_back(index);
+		}
+		catch (...)
+		{
+			w = std::move(_widgets.back());
+			_widgets.pop_back();
+			throw;
+		}
+		_free = _slots[index].position;
+		_slots[index].position = static_cast<std::uint32_t>(_widgets.size() - 1);
+		return {index,_slots[index].generation};
+	}
+public:
+	using iterator = std::vector<any_widget>::iterator;
+
+	/**
+	 * @brief Takes ownership of w.
+	 */
+	template<class W,std::enable_if_t<is_drawable_widget_v<W>,int> = 0>
+	widget_handle add(W&& w)
+	{
+		return insert(any_widget(std::move(w)));
+	}
+	/**
+	 * @brief Creates a W from args.
+	 */
+	template<class W,class... Args>
+	widget_handle emplace(Args&&... args)
+	{
+		any_widget w;
+		w.emplace<W>(std::forward<Args>(args)...);
+		return insert(std::move(w));
+	}
+	/**
+	 * @brief Destroys the widget h refers to.
+	 * @return false if h refers to no widget.
+	 */
+	bool remove(widget_handle h)
+	{
+		if (!contains(h))
+			return false;
+		std::uint32_t position = _slots[h.index].position;
+		std::uint32_t last = static_cast<std::uint32_t>(_widgets.size() - 1);
+		if (position != last)
+		{
+			_widgets[position] = std::move(_widgets[last]);
+			_slotOf[position] = _slotOf[last];
+			_slots[_slotOf[position]].position = position;
+		}
+		_widgets.pop_back();
+		_slotOf.pop_back();
+		++_slots[h.index].generation;
+		_slots[h.index].position = _free;
+		_free = h.index;
+		return true;
+	}
+	/**
+	 * @brief Destroys every widget.
+	 */
+	void clear()
+	{
+		for (auto index : _slotOf)
+		{
+			++_slots[index].generation;
+			_slots[index].position = _free;
+			_free = index;
+		}
+		_widgets.clear();
+		_slotOf.clear();
+	}
+	bool contains(widget_handle h) const
+	{
+		return h.index < _slots.size() && _slots[h.index].generation == h.generation;
+	}
+	/**
+	 * @brief The widget h refers to, nullptr if it was removed.
+	 */
+	any_widget* get(widget_handle h)
+	{
+		return contains(h) ? &_widgets[_slots[h.index].position] : nullptr;
+	}
+	/**
+	 * @brief The widget h refers to, nullptr if it was removed or is not a W.
+	 */
+	template<class W>
+	W* get(widget_handle h)
+	{
+		any_widget* w = get(h);
+		return w ? w->get<W>() : nullptr;
+	}
+	/**
+	 * @brief Handle of the widget at position i of the iteration order.
+	 */
+	widget_handle handleAt(std::size_t i) const
+	{
+		std::uint32_t index = _slotOf[i];
+		return {index,_slots[index].generation};
+	}
+	std::size_t size() const
+	{
+		return _widgets.size();
+	}
+	bool empty() const
+	{
+		return _widgets.empty();
+	}
+	iterator begin()
+	{
+		return _widgets.begin();
+	}
+	iterator end()
+	{
+		return _widgets.end();
+	}
+	/**
+	 * @brief Draws every widget, with a box if it has one.
+	 */
+	void drawAll()
+	{
+		for (auto& w : _widgets)
+			if (w)
+				w.draw(static_cast<CDKOBJS*>(w.base()._vptr)->box);
+	}
+	/**
+	 * @brief Erases every widget from the screen, they are not destroyed.
+	 */
+	void eraseAll()
+	{
+		for (auto& w : _widgets)
+			if (w)
+				w.erase();
+	}
+	/**
+	 * @brief Moves every widget by offset.
+	 */
+	void moveAll(point offset,bool refresh = false)
+	{
+		for (auto& w : _widgets)
+			if (w)
+				w.move(offset,{true,refresh});
+	}
+};
+
+inline void screen::registry_deleter::operator()(widget_registry* r) const
+{
+	delete r;
+}
+
+inline widget_registry& screen::widgets()
+{
+	if (!_widgets)
+		_widgets.reset(new widget_registry);
+	return *_widgets;
+}
+
+/**
+ * @brief Box characters and attributes set together by applyStyle.
+ * Members left empty keep the widget's current value.
+ */
+struct style
+{
+	std::optional<chtype> ulChar;
+	std::optional<chtype> urChar;
+	std::optional<chtype> llChar;
+	std::optional<chtype> lrChar;
+	std::optional<chtype> horizontalChar;
+	std::optional<chtype> verticalChar;
+	std::optional<chtype> boxAttribute;
+	std::optional<chtype> backgroundAttribute;
+};
+
+namespace detail
+{
+inline widget& widgetOf(widget& w)
+{
+	return w;
+}
+inline widget& widgetOf(widget* w)
+{
+	return *w;
+}
+template<std::size_t Capacity>
+widget& widgetOf(basic_any_widget<Capacity>& w)
+{
+	return w.base();
+}
+
+/**
+ * Sets s on the widget through its libcdk function table and marks
+ * it dirty once, remembering its screen in screens.
+ */
+inline void setStyle(widget& w,const style& s,std::vector<screen*>& screens)
+{
+	auto obj = static_cast<CDKOBJS*>(w._vptr);
+	if (!obj)
+		return;
+	if (s.ulChar)
+		obj->fn->setULcharObj(obj,*s.ulChar);
+	if (s.urChar)
+		obj->fn->setURcharObj(obj,*s.urChar);
+	if (s.llChar)
+		obj->fn->setLLcharObj(obj,*s.llChar);
+	if (s.lrChar)
+		obj->fn->setLRcharObj(obj,*s.lrChar);
+	if (s.horizontalChar)
+		obj->fn->setHZcharObj(obj,*s.horizontalChar);
+	if (s.verticalChar)
+		obj->fn->setVTcharObj(obj,*s.verticalChar);
+	if (s.boxAttribute)
+		obj->fn->setBXattrObj(obj,*s.boxAttribute);
+	if (s.backgroundAttribute)
+		obj->fn->setBKattrObj(obj,*s.backgroundAttribute);
+	if (w._screen)
+	{
+		w._screen->markDirty(w);
+		if (std::find(screens.begin(),screens.end(),w._screen) == screens.end())
+			screens.push_back(w._screen);
+	}
+}
+
+/**
+ * Redraws the widgets changed on each screen at once, unless a
+ * render_scheduler will do it on its next frame.
+ */
+inline void redrawStyled(const std::vector<screen*>& screens)
+{
+	for (auto s : screens)
+	{
+		if (!s->scheduler())
+			s->refreshDirty();
+	}
+}
+}//namespace detail
+
+/**
+ * @brief Sets s on every widget of widgets, then redraws them once.
+ * widgets may hold wrappers, pointers to them or any_widget
+ * handles, e.g. a screen's widgets().
+ */
+template<class Range>
+void applyStyle(Range&& widgets,const style& s)
+{
+	std::vector<screen*> screens;
+	for (auto&& w : widgets)
+		detail::setStyle(detail::widgetOf(w),s,screens);
+	detail::redrawStyled(screens);
+}
+/**
+ * @brief Sets s on a list of widgets, e.g. applyStyle({&ok,&cancel},s).
+ */
+inline void applyStyle(std::initializer_list<widget*> widgets,const style& s)
+{
+	std::vector<screen*> screens;
+	for (auto w : widgets)
+		detail::setStyle(*w,s,screens);
+	detail::redrawStyled(screens);
+}
+
+/**
+ * A managed curses label widget.
+*/
+class label : public basic_widget<vLABEL>
+{
+	struct deleter
+	{
+		void operator()(CDKLABEL* p)
+		{
+			destroyCDKLabel(p);
+		}
+	};
+	using labelptr = std::unique_ptr<CDKLABEL,deleter>;
+	labelptr _ptr;
+public:
+	/**
+	 * @brief Default constructor.
+	 * Creates an empty object, dont call
+	 * member functions without assigning
+	 * an initialized object
+	*/
+	label() = default;
+
+	label(screen& parent,point p,const StringList& message, drawing_options opt)
+	{
+		cstring_list v(message);
+		_ptr = labelptr(newCDKLabel(parent._ptr.get(),
+									p.x,p.y,
+									v.data(),v.size(),
+									opt.box,opt.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+	}
+	/**
+	 * @brief Creates the label from strings the caller gives up,
+	 * libcdk reads them in place instead of from a NUL-terminated copy.
+	 * A template so that braced lists keep choosing the StringList overload.
+	 */
+	template<class Strings,
+	         std::enable_if_t<std::is_same_v<Strings,std::vector<std::string>>,int> = 0>
+	label(screen& parent,point p,Strings&& message,drawing_options opt)
+	{
+		cstring_list v(message);
+		_ptr = labelptr(newCDKLabel(parent._ptr.get(),
+									p.x,p.y,
+									v.data(),v.size(),
+									opt.box,opt.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+	}
+	/**
+	 * @brief Draws the label widget on the screen.
+	 * @param box if true, the widget is drawn with a box.
+	*/
+	void draw(boolean box=false)
+	{
+		if (!defer(box))
+			drawCDKLabel(_ptr.get(),box);
+	}
+	/**
+	 * @brief Removes the widget from the screen.  This does NOT destroy the widget.
+	*/
+	void erase()
+	{
+		eraseCDKLabel(_ptr.get());
+	}
+	/**
+	 * @brief Returns true if the widget will be drawn with a box around it.
+	*/
+	bool getBox()
+	{
+		return getCDKLabelBox(_ptr.get());
+	}
+	/**
+	 * @brief Returns the contents of the label widget.
+	 * The lines are read in place, without copying, and
+	 * are valid until the message changes.
+	*/
+	chtype_lines getMessage()
+	{
+		int linesCount=0;
+		auto msg = getCDKLabelMessage(_ptr.get(),&linesCount);
+		return {msg,_ptr->infoLen,linesCount};
+	}
+	/**
+	 * @brief moves the widget to the given point.
+	 * @param p The parameters p.x and p.y are the new position of the widget.
+
+				- The parameter p.x may be an integer or one of the pre-defined values TOP, BOTTOM, and CENTER.
+
+				- The parameter p.y may be an integer or one of the pre-defined values LEFT, RIGHT, and CENTER.
+	 * @param o The parameter o.relative states whether the p.x/p.y pair is a relative move or an absolute move.
+	*/
+	void move(point p,move_options o)
+	{
+		moveCDKLabel(_ptr.get(),
+					 p.x,p.y,
+					 o.relative,o.refresh && !defer());
+	}
+	/**
+	 * @brief Allows the user to move the widget around the screen
+	 * via the cursor/keypad keys.
+	 * @sa cdk_position (3) for key bindings.
+	*/
+	void position()
+	{
+		positionCDKLabel(_ptr.get());
+	}
+	/**
+	 * @brief Allows the user to change the contents of the label widget.
+	 * The parameters are the same as the newCDKLabel.
+	*/
+	void set(const StringList& message,bool box)
+	{
+		cstring_list v(message);
+		setCDKLabel(_ptr.get(),
+					v.data(),v.size(),
+					box);
+		touch();
+	}
+	/**
+	 * @brief  Sets the background attribute of the widget.
+	 * @param attribute is a curses attribute,
+	 * e.g., A_BOLD.
+	*/
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKLabelBackgroundAttrib(_ptr.get(),attribute);
+		touch();
+	}
+	/**
+	 * @brief Sets the background color of the widget.
+	 * @param color is in the format of the Cdk format strings.
+	 * For more information see cdk_display (3).
+	*/
+	void setBackgroundColor(const char * color)
+	{
+		setCDKLabelBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	/**
+	 * @brief Sets whether the widget will be drawn with a box around it.
+	*/
+	void setBox(bool box)
+	{
+		setCDKLabelBox(_ptr.get(),box);
+		touch();
+	}
+	/**
+	 * @brief Sets the attribute of the box.
+	*/
+	void setBoxAttribute(chtype character)
+	{
+		setCDKLabelBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Sets the horizontal drawing character for the box to the given character.
+	*/
+	void setHorizontalChar(chtype character)
+	{
+		setCDKLabelHorizontalChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Sets the lower left hand corner of the widget's box to the given character.
+	*/
+	void setLLChar(chtype character)
+	{
+		setCDKLabelLLChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Sets the lower right hand corner of the widget's box to the given character.
+	*/
+	void setLRChar(chtype character)
+	{
+		setCDKLabelLRChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief This sets the contents of the label widget.
+	*/
+	void setMessage(const StringList& message)
+	{
+		cstring_list v(message);
+		setCDKLabelMessage(_ptr.get(),
+						   v.data(),v.size());
+		touch();
+	}
+	/**
+	 * @brief Thread-safe setMessage, applied on the next refresh.
+	 * The label may be moved meanwhile, the update is dropped if it is
+	 * destroyed.
+	 */
+	void postMessage(const StringList& message)
+	{
+		if (!_screen)
+			return;
+		std::vector<std::string> copy(message.begin(),message.end());
+		_screen->updates().post(_vptr,update_queue::message,0,
+		                        [p = _ptr.get(),s = _screen,copy = std::move(copy)]{
+			cstring_list v(StringList(copy.begin(),copy.end()));
+			setCDKLabelMessage(p,v.data(),v.size());
+			s->markObject(p);
+		});
+	}
+	/**
+	 * @brief Sets the upper left hand corner of the widget's box to the given character.
+	*/
+	void setULChar(chtype character)
+	{
+		setCDKLabelULChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Sets the upper right hand corner of the widget's box to the given character.
+	*/
+	void setURChar(chtype character)
+	{
+		setCDKLabelURChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Sets the vertical drawing character for the box to the given character.
+	*/
+	void setVerticalChar(chtype character)
+	{
+		setCDKLabelVerticalChar(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Waits for a user to press a key.
+	 * @param key is the key to wait for.
+	 * If no specific key is desired, use (char)0.
+	*/
+	char wait(char key)
+	{
+		return waitCDKLabel(_ptr.get(),key);
+	}
+
+};
+
+/** @brief Create and manage a curses button widget.
+ */
+class button : public basic_widget<vBUTTON>
+{
+	struct deleter
+	{
+		void operator()(CDKBUTTON* p)
+		{
+			destroyCDKButton(p);
+		}
+	};
+	using buttonptr = std::unique_ptr<CDKBUTTON,deleter>;
+	buttonptr _ptr;
+public:
+	button() = default;
+	/**
+	 * @brief Creates a new buttonbox widget.
+	 * @param s parent screen
+	 * @param p
+	 * @param message
+	 * @param o
+	 */
+	button(screen& s,point p, std::string_view message,tButtonCallback cb,drawing_options o)
+	{
+		_ptr = buttonptr(newCDKButton(s._ptr.get(),
+									  p.x,p.y,
+									  message.data(),
+									  cb,
+									  o.box,o.shadow));
+		_vptr = _ptr.get();
+		_screen = &s;
+	}
+	/**
+	 * @brief Activates the button widget and lets the user interact with the widget.
+	 * @param actions If non-NULL, the characters in the array will be  injected into the widget.
+	 * @return If the character entered into this widget is RETURN or TAB then this function will return a value from 0 to
+				the number of buttons -1, representing the button selected.  It will also set the widget data  exitType  to
+				vNORMAL.
+
+			If the character entered into this widget was ESCAPE then the widget will return a value of -1 and the wid‐
+			get data exitType will be set to vESCAPE_HIT.
+	 */
+	int activate(chtype * actions)
+	{
+		return activateCDKButton (_ptr.get(),actions);
+	}
+	/**
+	 * @brief Draws the button widget on the screen.
+	 * @param box whether the widget is drawn with a box.
+	 */
+	void draw (bool box)
+	{
+		if (!defer(box))
+			drawCDKButton (_ptr.get(),box);
+	}
+	/**
+	 * @brief Removes the widget from the screen.  This does NOT destroy the widget.
+	 */
+	void erase()
+	{
+		eraseCDKButton(_ptr.get());
+	}
+	/**
+	 * @brief Returns true if the widget will be drawn with a box around it.
+	 */
+	bool getBox()
+	{
+		return getCDKButtonBox (_ptr.get());
+	}
+	/**
+	 * @brief Returns the contents of the button widget.
+	 */
+	std::string_view getMessage()
+	{
+		auto msg = getCDKButtonMessage(_ptr.get());
+		return {reinterpret_cast<char*>(msg)};
+	}
+	/**
+	 * @brief Injects a single character into the widget.
+	 * @param input the character to inject into the widget.
+	 * @return
+	 */
+	int inject(chtype input)
+	{
+		return injectCDKButtonbox (_ptr.get(),input);
+	}
+	/**
+	 * @brief set
+	 * @param message
+	 * @param box
+	 */
+	void set(std::string_view message,bool box)
+	{
+		setCDKButton(_ptr.get(),message.data(),box);
+		touch();
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKButtonBackgroundAttrib (_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor(const char* color )
+	{
+		setCDKButtonBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKButtonBox(_ptr.get(), box);
+		touch();
+	}
+	void setBoxAttribute(chtype c)
+	{
+		setCDKButtonBoxAttribute(_ptr.get(),c);
+		touch();
+	}
+	void setHorizontalChar(chtype c)
+	{
+		setCDKButtonHorizontalChar(_ptr.get(),c);
+		touch();
+	}
+	void setLLChar(chtype c)
+	{
+		setCDKButtonLLChar(_ptr.get(),c);
+		touch();
+	}
+	void setLRChar (chtype c)
+	{
+		setCDKButtonLRChar(_ptr.get(),c);
+		touch();
+	}
+	void setMessage(std::string_view message)
+	{
+		setCDKButtonMessage(_ptr.get(),message.data());
+		touch();
+	}
+	void setULChar(chtype c)
+	{
+		setCDKButtonULChar(_ptr.get(),c);
+		touch();
+	}
+	void setURChar(chtype c)
+	{
+		setCDKButtonURChar(_ptr.get(),c);
+		touch();
+	}
+	void setVerticalChar(chtype c)
+	{
+		setCDKButtonVerticalChar(_ptr.get(),c);
+		touch();
+	}
+	/**
+	 * @brief Moves the given widget to the given position.
+	 * @param p The new position of the widget.
+	 * @param o the options
+	 */
+	void move(point p,move_options o)
+	{
+		moveCDKButton(_ptr.get(),
+					  p.x,p.y,
+					  o.relative,o.refresh && !defer());
+	}
+	/**
+	 * @brief Allows  the user to move the widget around the screen via the cursor/keypad keys.
+	 * @sa cdk_position (3) for key bindings.
+	 */
+	void position()
+	{
+		positionCDKButton(_ptr.get());
+	}
+	///man cdk_button(3) documents this function but it
+	/// appears that it doesn't exist
+//	void wait(char key)
+//	{
+//		waitCDKButton(_ptr.get(),key);
+//	}
+};
+
+/**
+ * @brief Text entry widget
+ */
+class text_entry : public basic_widget<vENTRY>
+{
+	struct deleter
+	{
+		void operator()(CDKENTRY* p)
+		{
+			destroyCDKEntry(p);
+		}
+	};
+	using entryptr = std::unique_ptr<CDKENTRY,deleter>;
+	entryptr _ptr;
+public:
+	text_entry(screen& parent,point p, std::string_view title,std::string_view label ,
+	           chtype fieldAttribute,
+	           chtype fillerCharacter,
+	           EDisplayType displayType,
+	           int fieldWidth,
+	           int minimumLength,
+	           int maximumLength,
+	           drawing_options o)
+	{
+		_ptr = entryptr(newCDKEntry(parent._ptr.get(),
+		           p.x,p.y,
+		           title.data(),
+		           label.data(),
+		           fieldAttribute,
+		           fillerCharacter,
+		           displayType,
+		           fieldWidth,
+		           minimumLength,
+		           maximumLength,
+		           o.box,
+		           o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+	}
+	char* activate(chtype *actions)
+	{
+		return activateCDKEntry (_ptr.get(),actions);
+	}
+	void clean()
+	{
+		cleanCDKEntry(_ptr.get());
+		touch();
+	}
+	void draw(bool box)
+	{
+		if (!defer(box))
+			drawCDKEntry(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKEntry (_ptr.get());
+	}
+	bool getBox()
+	{
+		return getCDKEntryBox(_ptr.get());
+	}
+	chtype getFillerChar ()
+	{
+		return getCDKEntryFillerChar(_ptr.get());
+	}
+	chtype getHiddenChar()
+	{
+		return getCDKEntryHiddenChar(_ptr.get());
+	}
+	int getMax()
+	{
+		return getCDKEntryMax(_ptr.get());
+	}
+	int getMin()
+	{
+		return getCDKEntryMin(_ptr.get());
+	}
+	char* getValue()
+	{
+		return getCDKEntryValue (_ptr.get());
+	}
+
+	char* inject(chtype input)
+	{
+		return injectCDKEntry (_ptr.get(),input);
+	}
+
+	void move(point p,move_options o)
+	{
+		moveCDKEntry (_ptr.get(),
+		                p.x,p.y,
+		                o.relative,
+		                o.refresh && !defer());
+	}
+	void position()
+	{
+		positionCDKEntry(_ptr.get());
+	}
+
+	void set(std::string_view value,
+	        int minimumLength,
+	        int maximumLength,
+	        bool box)
+	{
+		setCDKEntry(_ptr.get(),
+		            value.data(),
+		            minimumLength,
+		            maximumLength,
+		            box);
+		touch();
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKEntryBackgroundAttrib(_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor(const char * color)
+	{
+		setCDKEntryBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKEntryBox(_ptr.get(),box);
+		touch();
+	}
+	void setBoxAttribute (chtype character)
+	{
+		setCDKEntryBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	void setCB(ENTRYCB callBackFunction)
+	{
+		setCDKEntryCB (_ptr.get(),callBackFunction);
+	}
+
+	void setFillerChar(chtype character)
+	{
+		setCDKEntryFillerChar(_ptr.get(),character);
+		touch();
+	}
+
+	void setHiddenChar(chtype character)
+	{
+		setCDKEntryHiddenChar (_ptr.get(),character);
+		touch();
+	}
+
+	void setHighlight (chtype highlight,bool cursor)
+	{
+		setCDKEntryHighlight (_ptr.get(),highlight,cursor);
+		touch();
+	}
+	void setHorizontalChar(chtype character)
+	{
+		setCDKEntryHorizontalChar (_ptr.get(),character);
+		touch();
+	}
+	void setLLChar(chtype character)
+	{
+		setCDKEntryLLChar (_ptr.get(),character);
+		touch();
+	}
+
+	void setLRChar(chtype character)
+	{
+		setCDKEntryLRChar(_ptr.get(),character);
+		touch();
+	}
+	void setMax(int maximum)
+	{
+		setCDKEntryMax(_ptr.get(),maximum);
+		touch();
+	}
+	void setMin(int minimum)
+	{
+		setCDKEntryMin(_ptr.get(),minimum);
+		touch();
+	}
+
+	void setPostProcess(PROCESSFN callback,void * data)
+	{
+		setCDKEntryPostProcess (_ptr.get(),callback,data);
+	}
+	void setPreProcess(PROCESSFN callback,void * data)
+	{
+		setCDKEntryPreProcess (_ptr.get(),callback,data);
+	}
+	void setULChar(chtype character)
+	{
+		setCDKEntryULChar(_ptr.get(),character);
+		touch();
+	}
+	void setURChar(chtype character)
+	{
+		setCDKEntryURChar(_ptr.get(),character);
+		touch();
+	}
+	void setValue(std::string_view value)
+	{
+		setCDKEntryValue(_ptr.get(),value.data());
+		touch();
+	}
+	/**
+	 * @brief Thread-safe setValue, applied on the next refresh.
+	 * The entry may be moved meanwhile, the update is dropped if it is
+	 * destroyed.
+	 */
+	void postValue(std::string_view value)
+	{
+		if (!_screen)
+			return;
+		_screen->updates().post(_vptr,update_queue::value,0,
+		                        [p = _ptr.get(),s = _screen,copy = std::string(value)]{
+			setCDKEntryValue(p,copy.c_str());
+			s->markObject(p);
+		});
+	}
+	void setVerticalChar (chtype character)
+	{
+		setCDKEntryVerticalChar(_ptr.get(),character);
+		touch();
+	}
+
+};
+
+/**
+ * @brief How prepareList transforms a list.
+ */
+struct list_preparation
+{
+	/**
+	 * @brief Sort the items in byte order, as libcdk does.
+	 */
+	bool sort{true};
+	/**
+	 * @brief Remove repeated items, keeping the first one.
+	 */
+	bool unique{false};
+	/**
+	 * @brief Convert ASCII letters to lower case.
+	 */
+	bool foldCase{false};
+	/**
+	 * @brief Threads to use, 0 uses one per hardware thread.
+	 * Defaults to 1 so widgets never start threads unless asked to.
+	 */
+	unsigned threads{1};
+};
+
+namespace detail
+{
+/**
+ * Runs job(0) to job(count - 1), each on its own thread except the first.
+ */
+inline void parallel(std::size_t count,const std::function<void(std::size_t)>& job)
+{
+	std::vector<std::thread> pool;
+	for (std::size_t t = 1; t < count; ++t)
+		pool.emplace_back(job,t);
+	if (count)
+		job(0);
+	for (auto& th : pool)
+		th.join();
+}
+
+/**
+ * Splits size items into one part per thread, part t being
+ * [bounds[t], bounds[t + 1]). Short lists get a single part.
+ */
+inline std::vector<std::size_t> listParts(std::size_t size,unsigned threads)
+{
+	constexpr std::size_t min_items_per_thread = 8192;
+	std::size_t parts = threads ? threads : std::thread::hardware_concurrency();
+	parts = std::max<std::size_t>(1,std::min(parts,size / min_items_per_thread));
+	std::vector<std::size_t> bounds(parts + 1);
+	for (std::size_t t = 0; t <= parts; ++t)
+		bounds[t] = size * t / parts;
+	return bounds;
+}
+
+/**
+ * Sorts each part of items on its own thread and merges the parts
+ * pairwise in parallel, then removes duplicates, as opt asks.
+ */
+inline void finishList(StringList& items,const std::vector<std::size_t>& bounds,list_preparation opt)
+{
+	const std::size_t parts = bounds.size() - 1;
+	if (opt.sort)
+	{
+		parallel(parts,[&](std::size_t t){
+			std::sort(items.begin() + bounds[t],items.begin() + bounds[t + 1]);
+		});
+		for (std::size_t width = 1; width < parts; width *= 2)
+		{
+			std::size_t pairs = (parts + 2 * width - 1) / (2 * width);
+			parallel(pairs,[&](std::size_t pair){
+				std::size_t first = pair * 2 * width;
+				if (first + width >= parts)
+					return;
+				std::size_t last = std::min(first + 2 * width,parts);
+				std::inplace_merge(items.begin() + bounds[first],
+				                   items.begin() + bounds[first + width],
+				                   items.begin() + bounds[last]);
+			});
+		}
+		if (opt.unique)
+			items.erase(std::unique(items.begin(),items.end()),items.end());
+	}
+	else if (opt.unique)
+	{
+		std::unordered_set<std::string_view> seen;
+		items.erase(std::remove_if(items.begin(),items.end(),[&](std::string_view item){
+			return !seen.insert(item).second;
+		}),items.end());
+	}
+}
+}//namespace detail
+
+/**
+ * @brief Copies list into pool, sorting, removing duplicates and
+ * folding case as requested by opt.
+ * When opt allows more than one thread, lists long enough to be
+ * worth it are split among threads, each copies its part into its own
+ * range of one pool allocation and sorts the views, and the parts are
+ * merged pairwise in parallel.
+ * @return views into pool, their data() is NUL-terminated.
+ */
+inline StringList prepareList(const StringList& list,string_pool& pool,list_preparation opt = {})
+{
+	StringList out(list.size());
+	auto bounds = detail::listParts(list.size(),opt.threads);
+	const std::size_t parts = bounds.size() - 1;
+
+	std::vector<std::size_t> offsets(parts + 1);
+	detail::parallel(parts,[&](std::size_t t){
+		std::size_t bytes = 0;
+		for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+			bytes += list[i].size() + 1;
+		offsets[t + 1] = bytes;
+	});
+	std::partial_sum(offsets.begin(),offsets.end(),offsets.begin());
+	char* base = pool.allocate(offsets[parts]);
+
+	detail::parallel(parts,[&](std::size_t t){
+		char* p = base + offsets[t];
+		for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+		{
+			std::size_t n = list[i].size();
+			if (opt.foldCase)
+			{
+				for (std::size_t c = 0; c < n; ++c)
+					p[c] = static_cast<char>(tolower(static_cast<unsigned char>(list[i][c])));
+			}
+			else if (n)
+				std::memcpy(p,list[i].data(),n);
+			p[n] = '\0';
+			out[i] = std::string_view(p,n);
+			p += n + 1;
+		}
+	});
+	detail::finishList(out,bounds,opt);
+	return out;
+}
+
+/**
+ * @brief Moves list into pool, then sorts, removes duplicates and
+ * folds case as requested by opt without copying the characters.
+ * @return views into pool, their data() is NUL-terminated.
+ */
+inline StringList prepareList(std::vector<std::string>&& list,string_pool& pool,list_preparation opt = {})
+{
+	auto bounds = detail::listParts(list.size(),opt.threads);
+	if (opt.foldCase)
+	{
+		detail::parallel(bounds.size() - 1,[&](std::size_t t){
+			for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+			{
+				for (auto& c : list[i])
+					c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+			}
+		});
+	}
+	StringList out = pool.adopt(std::move(list));
+	detail::finishList(out,bounds,opt);
+	return out;
+}
+
+/**
+ * @brief Copies list into owned strings, see the string_pool overload.
+ */
+inline std::vector<std::string> prepareList(const StringList& list,list_preparation opt = {})
+{
+	string_pool pool;
+	StringList views = prepareList(list,pool,opt);
+	return std::vector<std::string>(views.begin(),views.end());
+}
+
+/**
+ * @brief Finds pattern in text.
+ * Uses SSE2, when available, to compare the first and last character
+ * of pattern at 16 positions at a time before comparing the rest.
+ * @return pointer to the first occurrence or nullptr.
+ */
+inline const char* findSubstring(std::string_view text,std::string_view pattern)
+{
+	const std::size_t n = pattern.size();
+	if (n == 0)
+		return text.data();
+	if (n > text.size())
+		return nullptr;
+	if (n == 1)
+		return static_cast<const char*>(std::memchr(text.data(),pattern[0],text.size()));
+	std::size_t i = 0;
+#if defined(__SSE2__) && defined(__GNUC__)
+	const __m128i first = _mm_set1_epi8(pattern[0]);
+	const __m128i last = _mm_set1_epi8(pattern[n - 1]);
+	for (; i + n - 1 + 16 <= text.size(); i += 16)
+	{
+		__m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+		__m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + n - 1));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+		        _mm_and_si128(_mm_cmpeq_epi8(first,blockFirst),_mm_cmpeq_epi8(last,blockLast))));
+		while (mask)
+		{
+			std::size_t pos = i + static_cast<std::size_t>(__builtin_ctz(mask));
+			if (std::memcmp(text.data() + pos + 1,pattern.data() + 1,n - 2) == 0)
+				return text.data() + pos;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	auto pos = text.find(pattern,i);
+	return pos == std::string_view::npos ? nullptr : text.data() + pos;
+}
+
+/**
+ * @brief Calls line(text) for each line of chunk ended by '\n',
+ * text not including the newline.
+ * Uses SSE2, when available, to find all the newlines among 16
+ * bytes at a time, then memchr for the rest.
+ * @return the bytes after the last newline.
+ */
+template<class F>
+std::string_view splitLines(std::string_view chunk,F&& line)
+{
+	std::size_t start = 0;
+	std::size_t i = 0;
+#if defined(__SSE2__) && defined(__GNUC__)
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; i + 16 <= chunk.size(); i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk.data() + i));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block,newline)));
+		while (mask)
+		{
+			std::size_t pos = i + static_cast<std::size_t>(__builtin_ctz(mask));
+			line(chunk.substr(start,pos - start));
+			start = pos + 1;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	while (i < chunk.size())
+	{
+		auto p = static_cast<const char*>(std::memchr(chunk.data() + i,'\n',chunk.size() - i));
+		if (!p)
+			break;
+		std::size_t pos = static_cast<std::size_t>(p - chunk.data());
+		line(chunk.substr(start,pos - start));
+		start = i = pos + 1;
+	}
+	return chunk.substr(start);
+}
+
+/**
+ * @brief Line boundaries of a large buffer, found in the background.
+ * Worker threads scan consecutive chunks of the buffer for newlines
+ * with splitLines. Finished chunks are published in order, and the first
+ * chunk is small, so the first lines can be shown right away. The
+ * members are thread-safe and the buffer must outlive the index.
+ */
+class line_index
+{
+	struct chunk
+	{
+		std::vector<std::size_t> newlines;
+		bool ready{false};
+	};
+	static constexpr std::size_t first_chunk = 64 << 10;
+	static constexpr std::size_t chunk_size = 4 << 20;
+
+	std::string_view _text;
+	std::function<void()> _published;
+	mutable std::mutex _lock;
+	std::vector<chunk> _chunks;
+	/**
+	 * Newlines in the chunks before chunk c, for c up to _publishedChunks.
+	 * Guarded by _lock, as are _chunks, _publishedChunks and _progress.
+	 */
+	std::vector<std::size_t> _firstNewline;
+	std::size_t _publishedChunks{0};
+	label* _progress{nullptr};
+	std::atomic<std::size_t> _indexedBytes{0};
+	std::atomic<std::size_t> _next{0};
+	std::atomic<bool> _done{false};
+	std::atomic<bool> _stop{false};
+	std::vector<std::thread> _workers;
+
+	std::size_t chunkEnd(std::size_t c) const
+	{
+		return std::min(_text.size(),first_chunk + c * chunk_size);
+	}
+	std::size_t chunkBegin(std::size_t c) const
+	{
+		return c ? chunkEnd(c - 1) : 0;
+	}
+	void work()
+	{
+		for (std::size_t c = _next++; c < _chunks.size() && !_stop; c = _next++)
+		{
+			std::vector<std::size_t> found;
+			std::size_t begin = chunkBegin(c);
+			splitLines(_text.substr(begin,chunkEnd(c) - begin),[&](std::string_view line){
+				found.push_back(static_cast<std::size_t>(line.data() + line.size() - _text.data()));
+			});
+			publish(c,std::move(found));
+		}
+	}
+	void publish(std::size_t c,std::vector<std::size_t>&& found)
+	{
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+			_chunks[c].newlines = std::move(found);
+			_chunks[c].ready = true;
+			if (c != _publishedChunks)
+				return;
+			while (_publishedChunks < _chunks.size() && _chunks[_publishedChunks].ready)
+			{
+				_firstNewline[_publishedChunks + 1] = _firstNewline[_publishedChunks]
+				        + _chunks[_publishedChunks].newlines.size();
+				++_publishedChunks;
+			}
+			_indexedBytes = chunkEnd(_publishedChunks - 1);
+			_done = _publishedChunks == _chunks.size();
+			report();
+		}
+		if (_published)
+			_published();
+	}
+	/**
+	 * Call with _lock held.
+	 */
+	void report()
+	{
+		if (!_progress)
+			return;
+		std::string message;
+		if (_done)
+			message = std::to_string(count()) + " lines";
+		else
+			message = "Indexing " + std::to_string(_indexedBytes * 100 / _text.size()) + "%";
+		_progress->postMessage({message});
+	}
+	/**
+	 * Call with _lock held, as the functions below.
+	 */
+	std::size_t newlineCount() const
+	{
+		return _firstNewline[_publishedChunks];
+	}
+	/**
+	 * Offset of newline n, found in O(log chunks).
+	 */
+	std::size_t newlineAt(std::size_t n) const
+	{
+		auto first = _firstNewline.begin();
+		std::size_t c = static_cast<std::size_t>(std::upper_bound(first + 1,first + _publishedChunks + 1,n) - first) - 1;
+		return _chunks[c].newlines[n - _firstNewline[c]];
+	}
+	std::size_t count() const
+	{
+		std::size_t newlines = newlineCount();
+		std::size_t lastStart = newlines ? newlineAt(newlines - 1) + 1 : 0;
+		return newlines + (_done && lastStart < _text.size() ? 1 : 0);
+	}
+	std::string_view lineAt(std::size_t i) const
+	{
+		std::size_t begin = i ? newlineAt(i - 1) + 1 : 0;
+		std::size_t end = i < newlineCount() ? newlineAt(i) : _text.size();
+		return _text.substr(begin,end - begin);
+	}
+public:
+	/**
+	 * @brief Starts indexing text.
+	 * @param published called after each batch of lines is published,
+	 * from the indexing threads, possibly concurrently.
+	 * @param threads number of indexing threads, 0 to use one per core.
+	 */
+	explicit line_index(std::string_view text,
+	                    std::function<void()> published = {},
+	                    unsigned threads = 0)
+		:_text(text),_published(std::move(published))
+	{
+		std::size_t chunks = 0;
+		while (chunkEnd(chunks) < _text.size())
+			++chunks;
+		_chunks.resize(_text.empty() ? 0 : chunks + 1);
+		_firstNewline.resize(_chunks.size() + 1);
+		if (_chunks.empty())
+		{
+			_done = true;
+			return;
+		}
+		std::size_t workers = threads ? threads : std::max(1u,std::thread::hardware_concurrency());
+		workers = std::min(workers,_chunks.size());
+		for (std::size_t t = 0; t < workers; ++t)
+			_workers.emplace_back(&line_index::work,this);
+	}
+	line_index(const line_index&) = delete;
+	line_index& operator=(const line_index&) = delete;
+	~line_index()
+	{
+		_stop = true;
+		for (auto& worker : _workers)
+			worker.join();
+	}
+	/**
+	 * @brief Lines found so far, the total once done.
+	 * The last line counts only if it is not empty.
+	 */
+	std::size_t lineCount() const
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		return count();
+	}
+	/**
+	 * @brief Line i without its newline, i must be below lineCount().
+	 */
+	std::string_view line(std::size_t i) const
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		return lineAt(i);
+	}
+	/**
+	 * @brief Up to count lines from line first, as line returns them,
+	 * read under a single lock.
+	 */
+	StringList lines(std::size_t first,std::size_t count) const
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		StringList result;
+		std::size_t total = this->count();
+		if (first < total)
+			count = std::min(count,total - first);
+		else
+			count = 0;
+		result.reserve(count);
+		for (std::size_t i = first; i < first + count; ++i)
+			result.push_back(lineAt(i));
+		return result;
+	}
+	/**
+	 * @brief Bytes of the buffer whose lines were published.
+	 */
+	std::size_t indexedBytes() const
+	{
+		return _indexedBytes;
+	}
+	std::size_t size() const
+	{
+		return _text.size();
+	}
+	/**
+	 * @brief Whether all lines were found.
+	 */
+	bool done() const
+	{
+		return _done;
+	}
+	/**
+	 * @brief Shows the progress in l with postMessage, nullptr stops it.
+	 * The label should be wide enough for "Indexing 100%" and the line
+	 * count, and must live until the refresh after it is replaced.
+	 */
+	void setProgressLabel(label* l)
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		_progress = l;
+		report();
+	}
+};
+
+/**
+ * @brief Scores how well text matches pattern as a subsequence, ignoring case.
+ * Consecutive characters and characters at the start of a word
+ * score higher, characters skipped before the first match lower.
+ * @return the score or -1 if pattern is not a subsequence of text.
+ */
+inline int fuzzyScore(std::string_view text,std::string_view pattern)
+{
+	int score = 0;
+	std::size_t t = 0;
+	std::size_t previous = std::string_view::npos;
+	for (char c : pattern)
+	{
+		int lower = tolower(static_cast<unsigned char>(c));
+		while (t < text.size() && tolower(static_cast<unsigned char>(text[t])) != lower)
+			++t;
+		if (t == text.size())
+			return -1;
+		score += 1;
+		if (previous != std::string_view::npos && t == previous + 1)
+			score += 5;
+		if (t == 0 || !isalnum(static_cast<unsigned char>(text[t - 1])))
+			score += 3;
+		if (previous == std::string_view::npos)
+			score -= static_cast<int>(std::min<std::size_t>(t,10));
+		previous = t++;
+	}
+	return std::max(score,0);
+}
+
+/**
+ * @brief How list_matcher compares items with the query.
+ */
+enum class match_mode
+{
+	prefix,
+	substring,
+	fuzzy
+};
+
+/**
+ * @brief Finds the items of a list that match a query.
+ * When the query grows by appending characters only the items that
+ * matched the previous query are searched again, call reset when the
+ * list itself changes.
+ */
+class list_matcher
+{
+public:
+	/**
+	 * @brief Custom match function, returns a score or -1 if item does not match.
+	 */
+	using match_function = std::function<int(std::string_view item,std::string_view query)>;
+private:
+	match_mode _mode{match_mode::substring};
+	match_function _custom;
+	std::string _query;
+	std::vector<std::size_t> _matches;
+	std::vector<int> _scores;
+	bool _valid{false};
+
+	int score(std::string_view item,std::string_view query) const
+	{
+		if (_custom)
+			return _custom(item,query);
+		switch (_mode)
+		{
+		case match_mode::prefix:
+			return item.substr(0,query.size()) == query ? 0 : -1;
+		case match_mode::substring:
+			return findSubstring(item,query) ? 0 : -1;
+		case match_mode::fuzzy:
+			return fuzzyScore(item,query);
+		}
+		return -1;
+	}
+public:
+	list_matcher(match_mode mode = match_mode::substring):_mode(mode)
+	{}
+	/**
+	 * @brief Uses a custom function, its matches are never refined
+	 * incrementally.
+	 */
+	list_matcher(match_function f):_custom(std::move(f))
+	{}
+	match_mode mode() const
+	{
+		return _mode;
+	}
+	/**
+	 * @brief Forgets the previous matches.
+	 */
+	void reset()
+	{
+		_valid = false;
+		_query.clear();
+	}
+	/**
+	 * @brief Matches query against items.
+	 * @param items random access container of strings.
+	 * @return indexes of the matching items in ascending order.
+	 */
+	template<class Items>
+	const std::vector<std::size_t>& match(const Items& items,std::string_view query)
+	{
+		bool refine = _valid && !_custom
+		        && query.size() >= _query.size()
+		        && query.substr(0,_query.size()) == _query;
+		if (refine)
+		{
+			std::size_t kept = 0;
+			for (std::size_t m = 0; m < _matches.size(); ++m)
+			{
+				int sc = score(std::string_view(items[_matches[m]]),query);
+				if (sc >= 0)
+				{
+					_matches[kept] = _matches[m];
+					_scores[kept++] = sc;
+				}
+			}
+			_matches.resize(kept);
+			_scores.resize(kept);
+		}
+		else
+		{
+			_matches.clear();
+			_scores.clear();
+			for (std::size_t i = 0; i < items.size(); ++i)
+			{
+				int sc = score(std::string_view(items[i]),query);
+				if (sc >= 0)
+				{
+					_matches.push_back(i);
+					_scores.push_back(sc);
+				}
+			}
+		}
+		_query = query;
+		_valid = true;
+		return _matches;
+	}
+	/**
+	 * @brief The last matches in ascending order.
+	 */
+	const std::vector<std::size_t>& matches() const
+	{
+		return _matches;
+	}
+	/**
+	 * @brief The last matches, best score first.
+	 */
+	std::vector<std::size_t> ranked() const
+	{
+		std::vector<std::size_t> order(_matches.size());
+		for (std::size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(),order.end(),[this](std::size_t a,std::size_t b){
+			return _scores[a] > _scores[b];
+		});
+		for (auto& o : order)
+			o = _matches[o];
+		return order;
+	}
+};
+
+namespace detail
+{
+/**
+ * Rows a libcdk scroll list shows once it has enough items, worked
+ * out from the box height, border and title lines the way
+ * newCDKScroll does. libcdk caps viewSize at the number of items, so
+ * it cannot be read back while the list is empty.
+ */
+inline std::size_t scrollRows(screen& parent,int height,std::string_view title,bool box)
+{
+	int parentHeight = getmaxy(parent.window());
+	int boxHeight = height;
+	if (parentHeight > 0)
+	{
+		if (height <= 0)
+			boxHeight = parentHeight + height > 0 ? parentHeight + height : parentHeight;
+		else if (height > parentHeight)
+			boxHeight = parentHeight;
+	}
+	int titleLines = title.empty() ? 0 : static_cast<int>(std::count(title.begin(),title.end(),'\n')) + 1;
+	return static_cast<std::size_t>(std::max(boxHeight - (box ? 2 : 0) - titleLines,1));
+}
+}//namespace detail
+
+/**
+ * @brief Sorted list widget.
+ * alpha_list allows a user to select from a list of alphabetically sorted words.  The
+	   user can use the arrow keys to traverse through the list or type in the beginning  of  the
+	   word  and  the list will automatically adjust itself in the correct place in the scrolling
+	   list.  This widget, like the file selector widget, is a compound widget of both the  entry
+	   field widget and the scrolling list widget.
+ */
+class alpha_list : public basic_widget<vALPHALIST>
+{
+	struct deleter
+	{
+		void operator()(CDKALPHALIST* p)
+		{
+			destroyCDKAlphalist(p);
+		}
+	};
+	using alphalistptr = std::unique_ptr<CDKALPHALIST,deleter>;
+	alphalistptr _ptr;
+	/**
+	 * Owns the characters of the contents, shared with callers of
+	 * contentsPool so the views they hold outlive a change of contents.
+	 */
+	std::shared_ptr<string_pool> _pool;
+	/**
+	 * Bytes of _pool still used by _index, to know when erased
+	 * items waste enough of it to be worth compacting.
+	 */
+	std::size_t _liveBytes{0};
+	/**
+	 * Sorted views of the contents, in the same order libcdk keeps
+	 * them, used to search prefixes without scanning the list.
+	 */
+	StringList _index;
+	/**
+	 * While a filter is set the shown items are _matcher.matches(),
+	 * indexes in _index in ascending order.
+	 */
+	bool _filtered{false};
+	std::string _query;
+	list_matcher _matcher;
+	/**
+	 * The char* array handed to libcdk, kept between calls so its
+	 * capacity is reused and the pointers outlive each call.
+	 */
+	std::vector<char*> _items;
+	/**
+	 * libcdk only holds the shown items from _top that fit in the list,
+	 * _current is the current item among all the shown ones.
+	 */
+	std::size_t _top{0};
+	std::size_t _current{0};
+	std::size_t _rows{1};
+	/**
+	 * The hook given to setPreProcess. Until one is set libcdk keeps
+	 * its own completion hook on the entry field, which inject replaces
+	 * with findPrefix, so only the caller's hook is run there.
+	 */
+	PROCESSFN _preProcess{nullptr};
+	void* _preProcessData{nullptr};
+
+	template<class List>
+	void buildIndex(List&& list,list_preparation prep)
+	{
+		prep.sort = true;
+		auto pool = std::make_shared<string_pool>();
+		_index = prepareList(std::forward<List>(list),*pool,prep);
+		_pool = std::move(pool);
+		_liveBytes = _pool->bytesUsed();
+		_filtered = false;
+		_query.clear();
+		_matcher.reset();
+	}
+	StringList::iterator lowerBound(std::string_view item)
+	{
+		return std::lower_bound(_index.begin(),_index.end(),item);
+	}
+	/**
+	 * Copies the live items into a new pool once erased ones take
+	 * most of the old one, which is freed when nobody else holds it.
+	 */
+	void compactPool()
+	{
+		if (_pool->bytesUsed() <= 2 * _liveBytes + string_pool::default_block_size)
+			return;
+		auto pool = std::make_shared<string_pool>();
+		for (auto& item : _index)
+			item = pool->add(item);
+		_pool = std::move(pool);
+	}
+	std::size_t shownCount() const
+	{
+		return _filtered ? _matcher.matches().size() : _index.size();
+	}
+	std::string_view shownAt(std::size_t i) const
+	{
+		return _filtered ? _index[_matcher.matches()[i]] : _index[i];
+	}
+	/**
+	 * Fills _items with the shown items from _top that fit in the list.
+	 */
+	void marshalWindow()
+	{
+		std::size_t count = std::min(_rows,shownCount() - std::min(_top,shownCount()));
+		_items.clear();
+		for (std::size_t i = 0; i < count; ++i)
+			_items.push_back(const_cast<char*>(shownAt(_top + i).data()));
+	}
+	/**
+	 * Hands the window of shown items to libcdk, which copies and sorts
+	 * what it is given, so the cost does not grow with the matches.
+	 */
+	void loadWindow()
+	{
+		marshalWindow();
+		setCDKAlphalistContents(_ptr.get(),_items.data(),static_cast<int>(_items.size()));
+		if (!_items.empty())
+			setCDKAlphalistCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+	}
+	/**
+	 * Makes item the current one, the window is reloaded only when
+	 * the item is not in it.
+	 */
+	void moveTo(std::size_t item)
+	{
+		std::size_t size = shownCount();
+		_current = size ? std::min(item,size - 1) : 0;
+		std::size_t top = _top;
+		if (_current < top)
+			top = _current;
+		else if (_current >= top + _rows)
+			top = _current + 1 - _rows;
+		if (top != _top)
+		{
+			_top = top;
+			loadWindow();
+		}
+		else if (size)
+		{
+			setCDKAlphalistCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+		}
+		touch();
+	}
+	/**
+	 * First position in the shown items not less than item.
+	 */
+	std::size_t shownLowerBound(std::string_view item) const
+	{
+		std::size_t lo = 0, hi = shownCount();
+		while (lo < hi)
+		{
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (shownAt(mid) < item)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+	/**
+	 * Reloads libcdk after the shown items changed and keeps the
+	 * selected item selected.
+	 */
+	void pushShown(std::string_view selected)
+	{
+		std::size_t size = shownCount();
+		_current = selected.empty() || !size ? 0 : std::min(shownLowerBound(selected),size - 1);
+		_top = std::min(_top,size > _rows ? size - _rows : 0);
+		if (_current < _top)
+			_top = _current;
+		else if (_current >= _top + _rows)
+			_top = _current + 1 - _rows;
+		loadWindow();
+		touch();
+	}
+	/**
+	 * Updates libcdk after _index changed.
+	 */
+	void pushContents(std::string_view selected)
+	{
+		if (_filtered)
+		{
+			_matcher.reset();
+			_matcher.match(_index,_query);
+		}
+		pushShown(selected);
+	}
+	std::string currentText()
+	{
+		if (_current >= shownCount())
+			return {};
+		return std::string(shownAt(_current));
+	}
+	std::string entryText()
+	{
+		const char* typed = getCDKEntryValue(_ptr->entryField);
+		return typed ? typed : "";
+	}
+	std::size_t entryCursor(const std::string& text)
+	{
+		auto entry = _ptr->entryField;
+		return std::min(static_cast<std::size_t>(std::max(entry->leftChar + entry->screenCol,0)),text.size());
+	}
+	void setEntry(const std::string& text,int left,int column)
+	{
+		auto entry = _ptr->entryField;
+		setCDKEntryValue(entry,text.c_str());
+		entry->leftChar = std::max(left,0);
+		entry->screenCol = std::max(column,0);
+		draw(ObjOf(_ptr.get())->box);
+	}
+	/**
+	 * Moves to item and shows it in the entry field, as libcdk does
+	 * for the arrow and page keys.
+	 */
+	void showItem(std::size_t item)
+	{
+		if (!shownCount())
+		{
+			beep();
+			return;
+		}
+		moveTo(item);
+		setCDKEntryValue(_ptr->entryField,currentText().c_str());
+		draw(ObjOf(_ptr.get())->box);
+	}
+	/**
+	 * Inserts c at the cursor of the entry field, moving the cursor as
+	 * libcdk does, and jumps to the first item starting with the text.
+	 * Beeps and leaves the text alone if the field is full or no item
+	 * starts with it.
+	 */
+	void typeAtCursor(char c)
+	{
+		auto entry = _ptr->entryField;
+		std::string text = entryText();
+		if (static_cast<int>(text.size()) >= entry->max)
+		{
+			beep();
+			return;
+		}
+		text.insert(entryCursor(text),1,c);
+		int left = entry->leftChar;
+		int column = entry->screenCol;
+		if (!jumpTo(text))
+		{
+			beep();
+			return;
+		}
+		if (column == entry->fieldWidth - 1)
+			++left;
+		else
+			++column;
+		setEntry(text,left,column);
+	}
+	/**
+	 * Deletes the character before the cursor, or under it, and jumps
+	 * to the first item starting with what is left.
+	 */
+	void eraseAtCursor(bool backspace)
+	{
+		auto entry = _ptr->entryField;
+		std::string text = entryText();
+		std::size_t cursor = entryCursor(text);
+		if (backspace ? cursor == 0 : cursor == text.size())
+		{
+			beep();
+			return;
+		}
+		text.erase(backspace ? cursor - 1 : cursor,1);
+		int left = entry->leftChar;
+		int column = entry->screenCol;
+		if (text.empty())
+			moveTo(0);
+		else if (!jumpTo(text))
+		{
+			beep();
+			return;
+		}
+		if (backspace)
+		{
+			if (column > 0)
+				--column;
+			else
+				--left;
+		}
+		setEntry(text,left,column);
+	}
+	/**
+	 * Completes the entry text to the longest prefix shared by the
+	 * shown items starting with it, the first and last of them.
+	 */
+	void complete()
+	{
+		std::string text = entryText();
+		int first = text.empty() ? -1 : findPrefix(text);
+		if (first < 0)
+		{
+			beep();
+			return;
+		}
+		std::size_t lo = static_cast<std::size_t>(first), hi = shownCount();
+		while (lo < hi)
+		{
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (shownAt(mid).substr(0,text.size()) == text)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		std::string_view a = shownAt(static_cast<std::size_t>(first));
+		std::string_view b = shownAt(lo - 1);
+		std::size_t common = static_cast<std::size_t>(std::mismatch(a.begin(),a.end(),b.begin(),b.end()).first - a.begin());
+		std::string completed(a.substr(0,common));
+		moveTo(static_cast<std::size_t>(first));
+		setCDKEntryValue(_ptr->entryField,completed.c_str());
+		draw(ObjOf(_ptr.get())->box);
+	}
+	/**
+	 * Keys inject handles itself because libcdk would only see the window.
+	 */
+	static bool handles(chtype input)
+	{
+		switch (input)
+		{
+		case KEY_UP:
+		case KEY_DOWN:
+		case KEY_PPAGE:
+		case KEY_NPAGE:
+		case KEY_BACKSPACE:
+		case KEY_DC:
+		case KEY_TAB:
+		case 127:
+		case 8:
+			return true;
+		}
+		return input < 256 && isprint(static_cast<int>(input));
+	}
+	void create(screen& parent,point p,widget_size size,
+	            std::string_view title,std::string_view label,
+	            chtype fillerCharacter,chtype highlight,drawing_options o)
+	{
+		// The entry field keeps the title, a line of text and a border
+		// line shared with the list below it.
+		std::size_t rows = detail::scrollRows(parent,size.height,title,o.box);
+		std::size_t entryRows = o.box ? 2 : 1;
+		_rows = rows > entryRows ? rows - entryRows : 1;
+		marshalWindow();
+		_ptr = alphalistptr(newCDKAlphalist (
+		           parent._ptr.get(),
+		           p.x,
+		           p.y,
+		           size.height,
+		           size.width,
+		           title.data(),
+		           label.data(),
+		           _items.data(),
+		           static_cast<int>(_items.size()),
+		           fillerCharacter,
+		           highlight,
+		           o.box,
+		           o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+	}
+public:
+	alpha_list() = default;
+
+
+	alpha_list(screen& parent, point p, widget_size size,
+	        std::string_view title,
+	        std::string_view  label,
+	        const StringList& list,
+	        chtype fillerCharacter,
+	        chtype highlight,
+	        drawing_options o,
+	        list_preparation prep = {})
+	{
+		buildIndex(list,prep);
+		create(parent,p,size,title,label,fillerCharacter,highlight,o);
+	}
+	/**
+	 * @brief Creates the list from strings the caller gives up, they
+	 * are moved into the widget instead of copied.
+	 * A template so that braced lists keep choosing the StringList overload.
+	 */
+	template<class Strings,
+	         std::enable_if_t<std::is_same_v<Strings,std::vector<std::string>>,int> = 0>
+	alpha_list(screen& parent, point p, widget_size size,
+	        std::string_view title,
+	        std::string_view  label,
+	        Strings&& list,
+	        chtype fillerCharacter,
+	        chtype highlight,
+	        drawing_options o,
+	        list_preparation prep = {})
+	{
+		buildIndex(std::move(list),prep);
+		create(parent,p,size,title,label,fillerCharacter,highlight,o);
+	}
+	/**
+	 * @brief Lets the user select an item, typed text is looked up
+	 * with findPrefix.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return the selected item, empty if escape was pressed.
+	 */
+	std::string activate(chtype* actions)
+	{
+		auto obj = ObjOf(_ptr.get());
+		obj->exitType = vNEVER_ACTIVATED;
+		drawCDKAlphalist(_ptr.get(),obj->box);
+		for (;;)
+		{
+			chtype input;
+			if (actions)
+			{
+				if (!*actions)
+					return {};
+				input = *actions++;
+			}
+			else
+			{
+				boolean functionKey;
+				input = static_cast<chtype>(getchCDKObject(ObjOf(_ptr->entryField),&functionKey));
+			}
+			const char* ret = inject(input);
+			if (obj->exitType != vEARLY_EXIT)
+				return ret ? ret : "";
+		}
+	}
+	void draw(bool box)
+	{
+		if (!defer(box))
+			drawCDKAlphalist(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKAlphalist(_ptr.get());
+	}
+	bool getBox()
+	{
+		return getCDKAlphalistBox(_ptr.get());
+	}
+	/**
+	 * @brief The shown items, in order.
+	 * The views point into contentsPool, they stay valid while the
+	 * widget keeps its contents or the pool is held.
+	 */
+	StringList getContents()
+	{
+		if (!_filtered)
+			return _index;
+		StringList shown;
+		shown.reserve(_matcher.matches().size());
+		for (auto i : _matcher.matches())
+			shown.push_back(_index[i]);
+		return shown;
+	}
+	/**
+	 * @brief The pool owning the characters of the contents.
+	 * Holding it keeps the views from getContents and rankedMatches
+	 * valid after the contents change.
+	 */
+	std::shared_ptr<const string_pool> contentsPool() const
+	{
+		return _pool;
+	}
+	int getCurrentItem()
+	{
+		return static_cast<int>(_current);
+	}
+	chtype getFillerChar()
+	{
+		return getCDKAlphalistFillerChar (_ptr.get());
+	}
+	chtype getHighlight()
+	{
+		return getCDKAlphalistHighlight(_ptr.get());
+	}
+	/**
+	 * @brief Injects a single key into the widget.
+	 * Printable keys are inserted at the cursor of the entry field and
+	 * the list jumps to the first item starting with its text, see
+	 * findPrefix. The arrow, page, delete and tab keys work on all the
+	 * shown items, not only the rows libcdk holds. As in libcdk the
+	 * pre-process hook runs first and can reject the key, then the key
+	 * bindings, then the post-process hook. Tab always completes.
+	 */
+	char* inject(chtype input)
+	{
+		if (!handles(input))
+			return injectCDKAlphalist(_ptr.get(),input);
+		auto entry = _ptr->entryField;
+		auto entryObj = ObjOf(entry);
+		ObjOf(_ptr.get())->exitType = vEARLY_EXIT;
+		if (_preProcess && !_preProcess(vENTRY,entry,_preProcessData,input))
+			return nullptr;
+		if (input != KEY_TAB && checkCDKObjectBind(vENTRY,entry,input))
+			return nullptr;
+		std::size_t page = _rows > 1 ? _rows - 1 : 1;
+		switch (input)
+		{
+		case KEY_UP:
+			showItem(_current ? _current - 1 : 0);
+			break;
+		case KEY_DOWN:
+			showItem(_current + 1);
+			break;
+		case KEY_PPAGE:
+			showItem(_current > page ? _current - page : 0);
+			break;
+		case KEY_NPAGE:
+			showItem(_current + page);
+			break;
+		case KEY_BACKSPACE:
+		case 127:
+		case 8:
+			eraseAtCursor(true);
+			break;
+		case KEY_DC:
+			eraseAtCursor(false);
+			break;
+		case KEY_TAB:
+			complete();
+			break;
+		default:
+			typeAtCursor(static_cast<char>(input));
+			break;
+		}
+		if (entryObj->postProcessFunction)
+			entryObj->postProcessFunction(vENTRY,entry,entryObj->postProcessData,input);
+		return nullptr;
+	}
+	/**
+	 * @brief Adds one item at its sorted position, the current
+	 * item stays selected.
+	 */
+	void insert(std::string_view item)
+	{
+		std::string selected = currentText();
+		_index.insert(lowerBound(item),_pool->add(item));
+		_liveBytes += item.size() + 1;
+		pushContents(selected);
+	}
+	/**
+	 * @brief Removes one occurrence of item.
+	 * If it was the current item the next one becomes current.
+	 * @return false if the list does not contain item.
+	 */
+	bool erase(std::string_view item)
+	{
+		auto it = lowerBound(item);
+		if (it == _index.end() || *it != item)
+			return false;
+		std::string selected = currentText();
+		_liveBytes -= it->size() + 1;
+		_index.erase(it);
+		compactPool();
+		pushContents(selected);
+		return true;
+	}
+	/**
+	 * @brief Removes and adds several items with a single update of the widget.
+	 * The current item stays selected, or the next one if it was removed.
+	 * Costs O(n + k log k) for k changes instead of re-sorting the list.
+	 * @param removed items to remove, one occurrence each.
+	 * @param added items to add.
+	 */
+	void applyDiff(const StringList& removed,const StringList& added)
+	{
+		StringList del(removed);
+		StringList add(added);
+		std::sort(del.begin(),del.end());
+		std::sort(add.begin(),add.end());
+		std::string selected = currentText();
+
+		StringList merged;
+		merged.reserve(_index.size() + add.size());
+		auto d = del.begin();
+		auto a = add.begin();
+		auto adopt = [&](std::string_view item){
+			merged.push_back(_pool->add(item));
+			_liveBytes += item.size() + 1;
+		};
+		for (auto item : _index)
+		{
+			while (d != del.end() && *d < item)
+				++d;
+			if (d != del.end() && *d == item)
+			{
+				++d;
+				_liveBytes -= item.size() + 1;
+				continue;
+			}
+			while (a != add.end() && *a < item)
+				adopt(*a++);
+			merged.push_back(item);
+		}
+		while (a != add.end())
+			adopt(*a++);
+		_index = std::move(merged);
+		compactPool();
+		pushContents(selected);
+	}
+	/**
+	 * @brief Finds the first shown item starting with prefix in O(log n).
+	 * @return the index of the item, as used by setCurrentItem, or -1.
+	 */
+	int findPrefix(std::string_view prefix) const
+	{
+		std::size_t pos = shownLowerBound(prefix);
+		if (pos == shownCount() || shownAt(pos).substr(0,prefix.size()) != prefix)
+			return -1;
+		return static_cast<int>(pos);
+	}
+	/**
+	 * @brief Shows only the items matching query, an empty query shows all.
+	 * Typing more characters refines the previous matches instead of
+	 * searching the whole list again. The contents passed to
+	 * set or setContents clear the filter.
+	 */
+	void filter(std::string_view query)
+	{
+		std::string selected = currentText();
+		if (query.empty())
+		{
+			_filtered = false;
+			_query.clear();
+		}
+		else
+		{
+			_matcher.match(_index,query);
+			_filtered = true;
+			_query = query;
+		}
+		pushShown(selected);
+	}
+	/**
+	 * @brief The current filter query.
+	 */
+	std::string_view getFilter() const
+	{
+		return _query;
+	}
+	/**
+	 * @brief Sets how filter matches items.
+	 */
+	void setMatcher(list_matcher matcher)
+	{
+		_matcher = std::move(matcher);
+		if (_filtered)
+			pushContents(currentText());
+	}
+	/**
+	 * @brief The items matching the filter, best match first.
+	 * The views are valid as those of getContents.
+	 */
+	StringList rankedMatches()
+	{
+		StringList ranked;
+		if (!_filtered)
+			return ranked;
+		for (auto i : _matcher.ranked())
+			ranked.push_back(_index[i]);
+		return ranked;
+	}
+	/**
+	 * @brief Makes the first item starting with prefix the current one.
+	 * @return false if no item starts with prefix.
+	 */
+	bool jumpTo(std::string_view prefix)
+	{
+		int item = findPrefix(prefix);
+		if (item < 0)
+			return false;
+		setCurrentItem(item);
+		return true;
+	}
+	void move(point p,move_options o)
+	{
+		moveCDKAlphalist(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
+	}
+	void position()
+	{
+		positionCDKAlphalist(_ptr.get());
+	}
+	/**
+	 * @brief Replaces the contents and the drawing attributes.
+	 * @param prep how the list is prepared, it is always sorted.
+	 */
+	void set(const StringList& list,chtype fillerCharacter,chtype highlight,bool box,
+	         list_preparation prep = {})
+	{
+		buildIndex(list,prep);
+		_top = 0;
+		_current = 0;
+		marshalWindow();
+		setCDKAlphalist(_ptr.get(),
+		        _items.data(),
+		        static_cast<int>(_items.size()),
+		        fillerCharacter,
+		        highlight,
+		        box);
+		touch();
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKAlphalistBackgroundAttrib (_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor (const char* color)
+	{
+		setCDKAlphalistBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKAlphalistBox(_ptr.get(),box);
+		touch();
+	}
+	void setBoxAttribute(chtype character)
+	{
+		setCDKAlphalistBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	/**
+	 * @brief Replaces the contents.
+	 * @param prep how the list is prepared, it is always sorted.
+	 */
+	void setContents (const StringList& c,list_preparation prep = {})
+	{
+		buildIndex(c,prep);
+		pushShown({});
+	}
+	/**
+	 * @brief Replaces the contents with strings the caller gives up,
+	 * they are moved into the widget instead of copied.
+	 */
+	template<class Strings,
+	         std::enable_if_t<std::is_same_v<Strings,std::vector<std::string>>,int> = 0>
+	void setContents(Strings&& c,list_preparation prep = {})
+	{
+		buildIndex(std::move(c),prep);
+		pushShown({});
+	}
+	void setCurrentItem(int item)
+	{
+		moveTo(static_cast<std::size_t>(std::max(item,0)));
+	}
+	void setFillerChar(chtype fillerCharacter)
+	{
+		setCDKAlphalistFillerChar(_ptr.get(),fillerCharacter);
+		touch();
+	}
+	void setHighlight(chtype highlight)
+	{
+		setCDKAlphalistHighlight (_ptr.get(),highlight);
+		touch();
+	}
+	void setHorizontalChar(chtype character)
+	{
+		setCDKAlphalistHorizontalChar (_ptr.get(),character);
+		touch();
+	}
+	void setLLChar(chtype character)
+	{
+		setCDKAlphalistLLChar(_ptr.get(),character);
+		touch();
+	}
+	void setLRChar(chtype character)
+	{
+		setCDKAlphalistLRChar(_ptr.get(),character);
+		touch();
+	}
+	void setPostProcess (PROCESSFN callback,void * data)
+	{
+		setCDKAlphalistPostProcess (_ptr.get(),callback, data);
+	}
+	void setPreProcess(PROCESSFN callback,void * data)
+	{
+		_preProcess = callback;
+		_preProcessData = data;
+		setCDKAlphalistPreProcess(_ptr.get(),callback,data);
+	}
+	void setULChar(chtype character)
+	{
+		setCDKAlphalistULChar (_ptr.get(),character);
+		touch();
+	}
+	void setURChar(chtype character)
+	{
+		setCDKAlphalistURChar (_ptr.get(),character);
+		touch();
+	}
+	void setVerticalChar(chtype character)
+	{
+		setCDKAlphalistVerticalChar(_ptr.get(),character);
+		touch();
+	}
+
+
+};
+
+/**
+ * @brief Random access to the items shown by a virtual_alpha_list.
+ * Items must be sorted and stay valid while they are shown.
+ */
+struct list_source
+{
+	std::function<std::size_t()> size;
+	std::function<std::string_view(std::size_t)> at;
+};
+
+/**
+ * @brief Makes a list_source for a sorted random access container of
+ * strings, the container must outlive the widget.
+ */
+template<class Container>
+list_source sourceOf(const Container& c)
+{
+	return {[&c]{ return static_cast<std::size_t>(c.size()); },
+	        [&c](std::size_t i){ return std::string_view(c[i]); }};
+}
+
+/**
+ * @brief Sorted list widget for very long lists.
+ * Behaves like alpha_list, arrow keys move through the list and
+ * typing jumps to the first item starting with the typed text,
+ * but the items are read from a list_source and only the visible
+ * rows are handed to libcdk, so creating it and memory use do not
+ * depend on the length of the list.
+ */
+class virtual_alpha_list : public basic_widget<vSCROLL>
+{
+	struct deleter
+	{
+		void operator()(CDKSCROLL* p)
+		{
+			destroyCDKScroll(p);
+		}
+	};
+	using scrollptr = std::unique_ptr<CDKSCROLL,deleter>;
+	scrollptr _ptr;
+	list_source _source;
+	std::string _filter;
+	std::size_t _top{0};
+	std::size_t _current{0};
+	std::size_t _rows{1};
+
+	std::size_t rows() const
+	{
+		return _rows;
+	}
+	void loadWindow()
+	{
+		std::size_t count = std::min(rows(),_source.size() - std::min(_top,_source.size()));
+		StringList window;
+		window.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			window.push_back(_source.at(_top + i));
+		cstring_list v(window);
+		setCDKScrollItems(_ptr.get(),v.data(),v.size(),false);
+		if (count)
+			setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+	}
+	void moveTo(std::size_t item)
+	{
+		std::size_t size = _source.size();
+		_current = size ? std::min(item,size - 1) : 0;
+		std::size_t top = _top;
+		if (_current < top)
+			top = _current;
+		else if (_current >= top + rows())
+			top = _current + 1 - rows();
+		if (top != _top)
+		{
+			_top = top;
+			loadWindow();
+		}
+		else if (size)
+		{
+			setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+		}
+		touch();
+	}
+	/**
+	 * @return whether an item starts with _filter.
+	 */
+	bool jumpToFilter()
+	{
+		std::size_t lo = 0, hi = _source.size();
+		while (lo < hi)
+		{
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (_source.at(mid) < _filter)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == _source.size() || _source.at(lo).substr(0,_filter.size()) != _filter)
+			return false;
+		moveTo(lo);
+		return true;
+	}
+public:
+	virtual_alpha_list() = default;
+	/**
+	 * @brief Creates the widget, the source is read on demand.
+	 * @param source sorted items to show.
+	 */
+	virtual_alpha_list(screen& parent, point p, widget_size size,
+	                   std::string_view title,
+	                   list_source source,
+	                   chtype highlight,
+	                   drawing_options o):_source(std::move(source))
+	{
+		_ptr = scrollptr(newCDKScroll(parent._ptr.get(),
+		                              p.x,p.y,
+		                              NONE,
+		                              size.height,
+		                              size.width,
+		                              title.data(),
+		                              nullptr,0,
+		                              false,
+		                              highlight,
+		                              o.box,
+		                              o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+		_rows = detail::scrollRows(parent,size.height,title,o.box);
+		loadWindow();
+	}
+	/**
+	 * @brief Lets the user pick an item.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return the index of the selected item or -1 if escape was pressed.
+	 */
+	long activate(chtype* actions)
+	{
+		ObjOf(_ptr.get())->exitType = vNEVER_ACTIVATED;
+		draw(ObjOf(_ptr.get())->box);
+		if (actions)
+		{
+			for (; *actions; ++actions)
+			{
+				long ret = inject(*actions);
+				if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+					return ret;
+			}
+			return -1;
+		}
+		WINDOW* win = ObjOf(_ptr.get())->inputWindow ? ObjOf(_ptr.get())->inputWindow : _ptr->win;
+		keypad(win,TRUE);
+		for (;;)
+		{
+			long ret = inject(static_cast<chtype>(wgetch(win)));
+			if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+				return ret;
+		}
+	}
+	/**
+	 * @brief Injects a single key into the widget.
+	 * @return the selected index on RETURN or TAB, otherwise -1.
+	 */
+	long inject(chtype input)
+	{
+		auto obj = ObjOf(_ptr.get());
+		obj->exitType = vEARLY_EXIT;
+		std::size_t size = _source.size();
+		switch (input)
+		{
+		case KEY_UP:
+			moveTo(_current ? _current - 1 : 0);
+			break;
+		case KEY_DOWN:
+			moveTo(_current + 1);
+			break;
+		case KEY_PPAGE:
+			moveTo(_current > rows() ? _current - rows() : 0);
+			break;
+		case KEY_NPAGE:
+			moveTo(_current + rows());
+			break;
+		case KEY_HOME:
+			moveTo(0);
+			break;
+		case KEY_END:
+			moveTo(size ? size - 1 : 0);
+			break;
+		case KEY_BACKSPACE:
+		case 127:
+		case 8:
+			if (!_filter.empty())
+			{
+				_filter.pop_back();
+				jumpToFilter();
+			}
+			break;
+		case KEY_ENTER:
+		case KEY_RETURN:
+		case KEY_TAB:
+			obj->exitType = vNORMAL;
+			return size ? static_cast<long>(_current) : -1;
+		case KEY_ESC:
+			obj->exitType = vESCAPE_HIT;
+			return -1;
+		default:
+			if (input < 256 && isprint(static_cast<int>(input)))
+			{
+				_filter.push_back(static_cast<char>(input));
+				if (!jumpToFilter())
+				{
+					_filter.pop_back();
+					beep();
+				}
+			}
+			break;
+		}
+		if (!defer())
+			drawCDKScroll(_ptr.get(),obj->box);
+		return -1;
+	}
+	/**
+	 * @brief Reloads the visible rows, call it after the source changes.
+	 */
+	void reload()
+	{
+		std::size_t size = _source.size();
+		if (_top >= size)
+			_top = size > rows() ? size - rows() : 0;
+		_current = size ? std::min(_current,size - 1) : 0;
+		loadWindow();
+		touch();
+	}
+	void setSource(list_source source)
+	{
+		_source = std::move(source);
+		_top = 0;
+		_current = 0;
+		_filter.clear();
+		reload();
+	}
+	void draw(bool box)
+	{
+		if (!defer(box))
+			drawCDKScroll(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKScroll(_ptr.get());
+	}
+	bool getBox()
+	{
+		return getCDKScrollBox(_ptr.get());
+	}
+	/**
+	 * @return index of the highlighted item in the source.
+	 */
+	std::size_t getCurrentItem() const
+	{
+		return _current;
+	}
+	void setCurrentItem(std::size_t item)
+	{
+		moveTo(item);
+	}
+	/**
+	 * @return the text typed so far to search the list.
+	 */
+	std::string_view getFilter() const
+	{
+		return _filter;
+	}
+	/**
+	 * @brief Jumps to the first item starting with prefix.
+	 * @return false if no item matches, the selection is not changed.
+	 */
+	bool setFilter(std::string_view prefix)
+	{
+		std::string old = std::move(_filter);
+		_filter = prefix;
+		if (jumpToFilter())
+			return true;
+		_filter = std::move(old);
+		return false;
+	}
+	chtype getHighlight()
+	{
+		return getCDKScrollHighlight(_ptr.get());
+	}
+	void move(point p,move_options o)
+	{
+		moveCDKScroll(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
+	}
+	void position()
+	{
+		positionCDKScroll(_ptr.get());
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKScrollBackgroundAttrib(_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor(const char* color)
+	{
+		setCDKScrollBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKScrollBox(_ptr.get(),box);
+		touch();
+	}
+	void setBoxAttribute(chtype character)
+	{
+		setCDKScrollBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	void setHighlight(chtype highlight)
+	{
+		setCDKScrollHighlight(_ptr.get(),highlight);
+		touch();
+	}
+	void setHorizontalChar(chtype character)
+	{
+		setCDKScrollHorizontalChar(_ptr.get(),character);
+		touch();
+	}
+	void setLLChar(chtype character)
+	{
+		setCDKScrollLLChar(_ptr.get(),character);
+		touch();
+	}
+	void setLRChar(chtype character)
+	{
+		setCDKScrollLRChar(_ptr.get(),character);
+		touch();
+	}
+	void setULChar(chtype character)
+	{
+		setCDKScrollULChar(_ptr.get(),character);
+		touch();
+	}
+	void setURChar(chtype character)
+	{
+		setCDKScrollURChar(_ptr.get(),character);
+		touch();
+	}
+	void setVerticalChar(chtype character)
+	{
+		setCDKScrollVerticalChar(_ptr.get(),character);
+		touch();
+	}
+
+};
+
+/**
+ * @brief Scrolling list widget.
+ */
+class scroll_list : public basic_widget<vSCROLL>
+{
+	struct deleter
+	{
+		void operator()(CDKSCROLL* p)
+		{
+			destroyCDKScroll(p);
+		}
+	};
+	using scrollptr = std::unique_ptr<CDKSCROLL,deleter>;
+	scrollptr _ptr;
+public:
+	scroll_list() = default;
+	/**
+	 * @param numbers whether the items are shown numbered.
+	 * @param scrollbar position of the scroll bar, LEFT, RIGHT or NONE.
+	 */
+	scroll_list(screen& parent, point p, widget_size size,
+	            std::string_view title,
+	            const StringList& items,
+	            bool numbers,
+	            chtype highlight,
+	            drawing_options o,
+	            int scrollbar = RIGHT)
+	{
+		cstring_list v(items);
+		_ptr = scrollptr(newCDKScroll(parent._ptr.get(),
+		                              p.x,p.y,
+		                              scrollbar,
+		                              size.height,
+		                              size.width,
+		                              title.data(),
+		                              v.data(),v.size(),
+		                              numbers,
+		                              highlight,
+		                              o.box,
+		                              o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+	}
+	/**
+	 * @brief Lets the user pick an item.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return the index of the selected item or -1 if escape was pressed.
+	 */
+	int activate(chtype* actions)
+	{
+		return activateCDKScroll(_ptr.get(),actions);
+	}
+	/**
+	 * @brief Injects a single key into the widget.
+	 * @return the selected index on RETURN or TAB, otherwise -1.
+	 */
+	int inject(chtype input)
+	{
+		return injectCDKScroll(_ptr.get(),input);
+	}
+	/**
+	 * @brief Adds an item at the end of the list.
+	 */
+	void addItem(std::string_view item)
+	{
+		addCDKScrollItem(_ptr.get(),std::string(item).c_str());
+		touch();
+	}
+	/**
+	 * @brief Inserts an item before the current one.
+	 */
+	void insertItem(std::string_view item)
+	{
+		insertCDKScrollItem(_ptr.get(),std::string(item).c_str());
+		touch();
+	}
+	void deleteItem(int position)
+	{
+		deleteCDKScrollItem(_ptr.get(),position);
+		touch();
+	}
+	void draw(bool box)
+	{
+		if (!defer(box))
+			drawCDKScroll(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKScroll(_ptr.get());
+	}
+	bool getBox()
+	{
+		return getCDKScrollBox(_ptr.get());
+	}
+	int getCurrentItem()
+	{
+		return getCDKScrollCurrentItem(_ptr.get());
+	}
+	int getCurrentTop()
+	{
+		return getCDKScrollCurrentTop(_ptr.get());
+	}
+	chtype getHighlight()
+	{
+		return getCDKScrollHighlight(_ptr.get());
+	}
+	/**
+	 * @brief Copies the items, without their attributes.
+	 */
+	std::vector<std::string> getItems()
+	{
+		std::vector<char*> items(static_cast<std::size_t>(getCDKScrollItems(_ptr.get(),nullptr)));
+		getCDKScrollItems(_ptr.get(),items.data());
+		std::vector<std::string> copy;
+		copy.reserve(items.size());
+		for (auto item : items)
+		{
+			copy.emplace_back(item ? item : "");
+			freeChar(item);
+		}
+		return copy;
+	}
+	int size()
+	{
+		return _ptr->listSize;
+	}
+	void move(point p,move_options o)
+	{
+		moveCDKScroll(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
+	}
+	void position()
+	{
+		positionCDKScroll(_ptr.get());
+	}
+	/**
+	 * @brief Replaces the items and the drawing attributes.
+	 */
+	void set(const StringList& items,bool numbers,chtype highlight,bool box)
+	{
+		cstring_list v(items);
+		setCDKScroll(_ptr.get(),v.data(),v.size(),numbers,highlight,box);
+		touch();
+	}
+	void setItems(const StringList& items,bool numbers)
+	{
+		cstring_list v(items);
+		setCDKScrollItems(_ptr.get(),v.data(),v.size(),numbers);
+		touch();
+	}
+	void setCurrentItem(int item)
+	{
+		setCDKScrollCurrentItem(_ptr.get(),item);
+		touch();
+	}
+	void setCurrentTop(int item)
+	{
+		setCDKScrollCurrentTop(_ptr.get(),item);
+		touch();
+	}
+	/**
+	 * @brief Makes item current, scrolling as needed.
+	 */
+	void setPosition(int item)
+	{
+		setCDKScrollPosition(_ptr.get(),item);
+		touch();
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKScrollBackgroundAttrib(_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor(const char* color)
+	{
+		setCDKScrollBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKScrollBox(_ptr.get(),box);
+		touch();
+	}
+	void setBoxAttribute(chtype character)
+	{
+		setCDKScrollBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	void setHighlight(chtype highlight)
+	{
+		setCDKScrollHighlight(_ptr.get(),highlight);
+		touch();
+	}
+	void setHorizontalChar(chtype character)
+	{
+		setCDKScrollHorizontalChar(_ptr.get(),character);
+		touch();
+	}
+	void setLLChar(chtype character)
+	{
+		setCDKScrollLLChar(_ptr.get(),character);
+		touch();
+	}
+	void setLRChar(chtype character)
+	{
+		setCDKScrollLRChar(_ptr.get(),character);
+		touch();
+	}
+	void setPostProcess(PROCESSFN callback,void * data)
+	{
+		setCDKScrollPostProcess(_ptr.get(),callback,data);
+	}
+	void setPreProcess(PROCESSFN callback,void * data)
+	{
+		setCDKScrollPreProcess(_ptr.get(),callback,data);
+	}
+	void setULChar(chtype character)
+	{
+		setCDKScrollULChar(_ptr.get(),character);
+		touch();
+	}
+	void setURChar(chtype character)
+	{
+		setCDKScrollURChar(_ptr.get(),character);
+		touch();
+	}
+	void setVerticalChar(chtype character)
+	{
+		setCDKScrollVerticalChar(_ptr.get(),character);
+		touch();
+	}
+};
+
+/**
+ * @brief Fixed capacity queue, pushing onto a full buffer
+ * overwrites the oldest element in place.
+ * Besides their position, elements have a sequence number counting
+ * the elements pushed before them, which does not change when older
+ * elements drop off, see first().
+ */
+template<class T>
+class ring_buffer
+{
+	std::vector<T> _items;
+	std::size_t _head{0};
+	std::size_t _size{0};
+	std::size_t _dropped{0};
+public:
+	explicit ring_buffer(std::size_t capacity = 1):_items(std::max<std::size_t>(capacity,1))
+	{}
+	/**
+	 * @brief Assigns value to the slot after the newest element,
+	 * which is the oldest one when the buffer is full.
+	 * Assigning reuses the slot, e.g. a std::string keeps its capacity.
+	 */
+	template<class U>
+	T& push_back(U&& value)
+	{
+		std::size_t slot;
+		if (_size < _items.size())
+		{
+			slot = (_head + _size++) % _items.size();
+		}
+		else
+		{
+			slot = _head;
+			_head = (_head + 1) % _items.size();
+			++_dropped;
+		}
+		_items[slot] = std::forward<U>(value);
+		return _items[slot];
+	}
+	/**
+	 * @brief The element at position i, 0 being the oldest.
+	 */
+	T& operator[](std::size_t i)
+	{
+		return _items[(_head + i) % _items.size()];
+	}
+	const T& operator[](std::size_t i) const
+	{
+		return _items[(_head + i) % _items.size()];
+	}
+	std::size_t size() const
+	{
+		return _size;
+	}
+	std::size_t capacity() const
+	{
+		return _items.size();
+	}
+	bool empty() const
+	{
+		return _size == 0;
+	}
+	/**
+	 * @brief Sequence number of the oldest element.
+	 */
+	std::size_t first() const
+	{
+		return _dropped;
+	}
+	/**
+	 * @brief Drops every element, the slots keep their storage.
+	 */
+	void clear()
+	{
+		_dropped += _size;
+		_head = 0;
+		_size = 0;
+	}
+};
+
+/**
+ * @brief Scrolling list of the last lines appended to it, for logs.
+ * Lines are kept in a ring_buffer, appending is O(1) and once it is
+ * full the oldest line is overwritten in place. Only the visible rows
+ * are given to libcdk, while following the end an append scrolls
+ * them by one row instead of reloading them all.
+ * Moving up stops following, moving back to the last line or
+ * pressing End resumes it.
+ */
+class log_viewer : public basic_widget<vSCROLL>
+{
+	struct deleter
+	{
+		void operator()(CDKSCROLL* p)
+		{
+			destroyCDKScroll(p);
+		}
+	};
+	using scrollptr = std::unique_ptr<CDKSCROLL,deleter>;
+	scrollptr _ptr;
+	ring_buffer<std::string> _lines;
+	/**
+	 * Sequence numbers, see ring_buffer, of the first visible line
+	 * and the highlighted one.
+	 */
+	std::size_t _top{0};
+	std::size_t _current{0};
+	/**
+	 * Rows given to libcdk.
+	 */
+	std::size_t _shown{0};
+	std::size_t _rows{1};
+	bool _follow{true};
+
+	std::size_t rows() const
+	{
+		return _rows;
+	}
+	std::size_t end() const
+	{
+		return _lines.first() + _lines.size();
+	}
+	void loadWindow()
+	{
+		_shown = std::min(rows(),end() - _top);
+		StringList window;
+		window.reserve(_shown);
+		for (std::size_t i = 0; i < _shown; ++i)
+			window.push_back(_lines[_top - _lines.first() + i]);
+		cstring_list v(window);
+		setCDKScrollItems(_ptr.get(),v.data(),v.size(),false);
+		if (_shown)
+			setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+	}
+	void moveTo(std::size_t line)
+	{
+		if (_lines.empty())
+			return;
+		_current = std::min(std::max(line,_lines.first()),end() - 1);
+		_follow = _current == end() - 1;
+		std::size_t top = _top;
+		if (_current < top)
+			top = _current;
+		else if (_current >= top + rows())
+			top = _current + 1 - rows();
+		if (top != _top)
+		{
+			_top = top;
+			loadWindow();
+		}
+		else
+		{
+			setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+		}
+		touch();
+	}
+public:
+	log_viewer() = default;
+	/**
+	 * @param capacity number of lines kept, older ones are dropped.
+	 */
+	log_viewer(screen& parent, point p, widget_size size,
+	           std::string_view title,
+	           std::size_t capacity,
+	           chtype highlight,
+	           drawing_options o):_lines(capacity)
+	{
+		_ptr = scrollptr(newCDKScroll(parent._ptr.get(),
+		                              p.x,p.y,
+		                              RIGHT,
+		                              size.height,
+		                              size.width,
+		                              title.data(),
+		                              nullptr,0,
+		                              false,
+		                              highlight,
+		                              o.box,
+		                              o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+		_rows = detail::scrollRows(parent,size.height,title,o.box);
+		//lets curses scroll the terminal instead of rewriting every row
+		idlok(_ptr->win,TRUE);
+	}
+	/**
+	 * @brief Adds a line at the end in O(1), dropping the oldest one
+	 * if the viewer is full.
+	 */
+	void append(std::string_view line)
+	{
+		const char* text = _lines.push_back(line).c_str();
+		if (_follow)
+		{
+			_current = end() - 1;
+			//add before deleting, libcdk clears the window when the list gets shorter than the view
+			addCDKScrollItem(_ptr.get(),text);
+			if (_shown == rows() || _top < _lines.first())
+			{
+				deleteCDKScrollItem(_ptr.get(),0);
+				++_top;
+			}
+			else
+			{
+				++_shown;
+			}
+			setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+			touch();
+		}
+		else if (_top < _lines.first())
+		{
+			//the top row dropped off, scroll the window by one row instead of reloading it
+			std::size_t next = _top + _shown;
+			if (next < end())
+				addCDKScrollItem(_ptr.get(),_lines[next - _lines.first()].c_str());
+			else
+				--_shown;
+			deleteCDKScrollItem(_ptr.get(),0);
+			_top = _lines.first();
+			_current = std::max(_current,_top);
+			if (_shown)
+				setCDKScrollCurrentItem(_ptr.get(),static_cast<int>(_current - _top));
+			touch();
+		}
+		else if (_shown < rows() && _top + _shown == end() - 1)
+		{
+			addCDKScrollItem(_ptr.get(),text);
+			++_shown;
+			touch();
+		}
+	}
+	/**
+	 * @brief Removes every line.
+	 */
+	void clear()
+	{
+		_lines.clear();
+		_top = _current = _lines.first();
+		_follow = true;
+		loadWindow();
+		touch();
+	}
+	/**
+	 * @brief The line at position i, 0 being the oldest kept.
+	 */
+	std::string_view line(std::size_t i) const
+	{
+		return _lines[i];
+	}
+	std::size_t size() const
+	{
+		return _lines.size();
+	}
+	std::size_t capacity() const
+	{
+		return _lines.capacity();
+	}
+	/**
+	 * @brief Whether appended lines scroll into view.
+	 */
+	bool following() const
+	{
+		return _follow;
+	}
+	/**
+	 * @brief Starts or stops following appended lines,
+	 * starting jumps to the last line.
+	 */
+	void follow(bool on)
+	{
+		if (on)
+			moveTo(end());
+		else
+			_follow = false;
+	}
+	/**
+	 * @brief Lets the user scroll through the lines.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return the position of the selected line or -1 if escape was pressed.
+	 */
+	long activate(chtype* actions)
+	{
+		ObjOf(_ptr.get())->exitType = vNEVER_ACTIVATED;
+		draw(ObjOf(_ptr.get())->box);
+		if (actions)
+		{
+			for (; *actions; ++actions)
+			{
+				long ret = inject(*actions);
+				if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+					return ret;
+			}
+			return -1;
+		}
+		WINDOW* win = ObjOf(_ptr.get())->inputWindow ? ObjOf(_ptr.get())->inputWindow : _ptr->win;
+		keypad(win,TRUE);
+		for (;;)
+		{
+			long ret = inject(static_cast<chtype>(wgetch(win)));
+			if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+				return ret;
+		}
+	}
+	/**
+	 * @brief Injects a single key into the widget.
+	 * @return the selected position on RETURN or TAB, otherwise -1.
+	 */
+	long inject(chtype input)
+	{
+		auto obj = ObjOf(_ptr.get());
+		obj->exitType = vEARLY_EXIT;
+		switch (input)
+		{
+		case KEY_UP:
+			moveTo(_current ? _current - 1 : 0);
+			break;
+		case KEY_DOWN:
+			moveTo(_current + 1);
+			break;
+		case KEY_PPAGE:
+			moveTo(_current > rows() ? _current - rows() : 0);
+			break;
+		case KEY_NPAGE:
+			moveTo(_current + rows());
+			break;
+		case KEY_HOME:
+			moveTo(0);
+			break;
+		case KEY_END:
+			moveTo(end());
+			break;
+		case KEY_ENTER:
+		case KEY_RETURN:
+		case KEY_TAB:
+			obj->exitType = vNORMAL;
+			return _lines.empty() ? -1 : static_cast<long>(_current - _lines.first());
+		case KEY_ESC:
+			obj->exitType = vESCAPE_HIT;
+			return -1;
+		default:
+			break;
+		}
+		if (!defer())
+			drawCDKScroll(_ptr.get(),obj->box);
+		return -1;
+	}
+	void draw(bool box)
+	{
+		if (!defer(box))
+			drawCDKScroll(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKScroll(_ptr.get());
+	}
+	bool getBox()
+	{
+		return getCDKScrollBox(_ptr.get());
+	}
+	/**
+	 * @return position of the highlighted line, 0 being the oldest kept.
+	 */
+	std::size_t getCurrentItem() const
+	{
+		return _current - _lines.first();
+	}
+	void setCurrentItem(std::size_t item)
+	{
+		moveTo(_lines.first() + item);
+	}
+	chtype getHighlight()
+	{
+		return getCDKScrollHighlight(_ptr.get());
+	}
+	void move(point p,move_options o)
+	{
+		moveCDKScroll(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
+	}
+	void position()
+	{
+		positionCDKScroll(_ptr.get());
+	}
+	void setBackgroundAttrib(chtype attribute)
+	{
+		setCDKScrollBackgroundAttrib(_ptr.get(),attribute);
+		touch();
+	}
+	void setBackgroundColor(const char* color)
+	{
+		setCDKScrollBackgroundColor(_ptr.get(),color);
+		touch();
+	}
+	void setBox(bool box)
+	{
+		setCDKScrollBox(_ptr.get(),box);
+		touch();
+	}
+	void setBoxAttribute(chtype character)
+	{
+		setCDKScrollBoxAttribute(_ptr.get(),character);
+		touch();
+	}
+	void setHighlight(chtype highlight)
+	{
+		setCDKScrollHighlight(_ptr.get(),highlight);
+		touch();
+	}
+	void setHorizontalChar(chtype character)
+	{
+		setCDKScrollHorizontalChar(_ptr.get(),character);
+		touch();
+	}
+	void setLLChar(chtype character)
+	{
+		setCDKScrollLLChar(_ptr.get(),character);
+		touch();
+	}
+	void setLRChar(chtype character)
+	{
+		setCDKScrollLRChar(_ptr.get(),character);
+		touch();
+	}
+	void setULChar(chtype character)
 	{
-		setCDKLabelVerticalChar(_ptr.get(),character);
+		setCDKScrollULChar(_ptr.get(),character);
+		touch();
 	}
-	/**
-	 * @brief Waits for a user to press a key.
-	 * @param key is the key to wait for.
-	 * If no specific key is desired, use (char)0.
-	*/
-	char wait(char key)
+	void setURChar(chtype character)
 	{
-		return waitCDKLabel(_ptr.get(),key);
+		setCDKScrollURChar(_ptr.get(),character);
+		touch();
+	}
+	void setVerticalChar(chtype character)
+	{
+		setCDKScrollVerticalChar(_ptr.get(),character);
+		touch();
 	}
-	EObjectType type{vLABEL};
-
 };
 
-/** @brief Create and manage a curses button widget.
+/**
+ * @brief Scrolling window widget for streams of text, e.g. logs.
+ * append takes chunks of bytes as they are read, complete lines are
+ * kept in a ring_buffer of saveLines lines and handed to libcdk in
+ * one call per frame, however many arrived since the last one. The
+ * window keeps showing the last line while it is scrolled to the bottom.
  */
-class button : public widget
+class scrolling_window : public basic_widget<vSWINDOW>
 {
 	struct deleter
 	{
-		void operator()(CDKBUTTON* p)
+		void operator()(CDKSWINDOW* p)
 		{
-			destroyCDKButton(p);
+			destroyCDKSwindow(p);
 		}
 	};
-	using buttonptr = std::unique_ptr<CDKBUTTON,deleter>;
-	buttonptr _ptr;
-public:
-	button() = default;
+	using swindowptr = std::unique_ptr<CDKSWINDOW,deleter>;
 	/**
-	 * @brief Creates a new buttonbox widget.
-	 * @param s parent screen
-	 * @param p
-	 * @param message
-	 * @param o
+	 * Lines waiting for the next frame. Shared with the flush posted
+	 * to the screen's update_queue, so the widget may be moved or
+	 * destroyed before it runs.
 	 */
-	button(screen& s,point p, std::string_view message,tButtonCallback cb,drawing_options o)
+	struct stream
+	{
+		widget target;
+		ring_buffer<std::string> lines;
+		std::string partial;
+		std::vector<char*> items;
+		std::size_t flushedFirst{0};
+		std::size_t pending{0};
+		bool queued{false};
+
+		explicit stream(std::size_t saveLines):lines(saveLines)
+		{}
+		void push(std::string_view line)
+		{
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+			lines.push_back(line);
+			++pending;
+		}
+		void flush()
+		{
+			queued = false;
+			if (!pending)
+				return;
+			auto w = static_cast<CDKSWINDOW*>(target._vptr);
+			bool bottom = w->currentTop >= w->maxTopLine;
+			int top = w->currentTop - static_cast<int>(lines.first() - flushedFirst);
+			//addCDKSwindow redraws and shifts the whole list for every
+			//line, hand libcdk the kept lines in one call instead
+			items.clear();
+			for (std::size_t i = 0; i < lines.size(); ++i)
+				items.push_back(lines[i].data());
+			setCDKSwindowContents(w,items.data(),static_cast<int>(items.size()));
+			w->currentTop = bottom ? w->maxTopLine : std::min(std::max(top,0),w->maxTopLine);
+			flushedFirst = lines.first();
+			pending = 0;
+			target.touch();
+		}
+	};
+	swindowptr _ptr;
+	std::shared_ptr<stream> _stream;
+
+	/**
+	 * Adds the partial line in pieces of max_partial_line bytes once it
+	 * gets that long, so a stream without newlines cannot grow it.
+	 */
+	void splitPartial()
 	{
-		_ptr = buttonptr(newCDKButton(s._ptr.get(),
-									  p.x,p.y,
-									  message.data(),
-									  cb,
-									  o.box,o.shadow));
-		_vptr = _ptr.get();
+		stream& s = *_stream;
+		std::size_t used = 0;
+		while (s.partial.size() - used >= max_partial_line)
+		{
+			s.push(std::string_view(s.partial).substr(used,max_partial_line));
+			used += max_partial_line;
+		}
+		s.partial.erase(0,used);
+	}
+
+	void schedule()
+	{
+		stream& s = *_stream;
+		if (s.queued || !s.pending)
+			return;
+		s.queued = true;
+		std::weak_ptr<stream> weak = _stream;
+		_screen->updates().post(&s,update_queue::custom,0,[weak]{
+			if (auto p = weak.lock())
+				p->flush();
+		});
+		touch();
 	}
+public:
 	/**
-	 * @brief Activates the button widget and lets the user interact with the widget.
-	 * @param actions If non-NULL, the characters in the array will be  injected into the widget.
-	 * @return If the character entered into this widget is RETURN or TAB then this function will return a value from 0 to
-				the number of buttons -1, representing the button selected.  It will also set the widget data  exitType  to
-				vNORMAL.
+	 * @brief Length at which append adds a line that has no newline yet.
+	 */
+	static constexpr std::size_t max_partial_line = 64 * 1024;
 
-			If the character entered into this widget was ESCAPE then the widget will return a value of -1 and the wid‐
-			get data exitType will be set to vESCAPE_HIT.
+	scrolling_window() = default;
+	/**
+	 * @param saveLines number of lines kept, older ones are dropped.
 	 */
-	int activate(chtype * actions)
+	scrolling_window(screen& parent, point p, widget_size size,
+	                 std::string_view title,
+	                 int saveLines,
+	                 drawing_options o)
 	{
-		return activateCDKButton (_ptr.get(),actions);
+		_ptr = swindowptr(newCDKSwindow(parent._ptr.get(),
+		                                p.x,p.y,
+		                                size.height,
+		                                size.width,
+		                                title.data(),
+		                                saveLines,
+		                                o.box,
+		                                o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+		_stream = std::make_shared<stream>(static_cast<std::size_t>(std::max(saveLines,1)));
+		_stream->target = *this;
 	}
 	/**
-	 * @brief Draws the button widget on the screen.
-	 * @param box whether the widget is drawn with a box.
+	 * @brief Adds the complete lines of a chunk of bytes on the next frame.
+	 * A line without its newline yet is kept until a later chunk
+	 * ends it, see endLine, or it reaches max_partial_line bytes.
+	 * "\r\n" line ends are accepted.
 	 */
-	void draw (bool box)
+	void append(std::string_view bytes)
+	{
+		stream& s = *_stream;
+		std::string_view rest = splitLines(bytes,[&s](std::string_view line){
+			if (s.partial.empty())
+			{
+				s.push(line);
+			}
+			else
+			{
+				s.partial.append(line);
+				s.push(s.partial);
+				s.partial.clear();
+			}
+		});
+		s.partial.append(rest);
+		splitPartial();
+		schedule();
+	}
+	/**
+	 * @brief Adds a line, which must not contain newlines, on the next frame.
+	 */
+	void appendLine(std::string_view line)
 	{
-		drawCDKButton (_ptr.get(),box);
+		_stream->push(line);
+		schedule();
 	}
 	/**
-	 * @brief Removes the widget from the screen.  This does NOT destroy the widget.
+	 * @brief Adds the partial line kept by append, e.g. when the stream ends.
 	 */
-	void erase()
+	void endLine()
 	{
-		eraseCDKButton(_ptr.get());
+		stream& s = *_stream;
+		if (s.partial.empty())
+			return;
+		s.push(s.partial);
+		s.partial.clear();
+		schedule();
 	}
 	/**
-	 * @brief Returns true if the widget will be drawn with a box around it.
+	 * @brief Hands the pending lines to libcdk now instead of on the next frame.
 	 */
-	bool getBox()
+	void flush()
 	{
-		return getCDKButtonBox (_ptr.get());
+		_stream->flush();
 	}
 	/**
-	 * @brief Returns the contents of the button widget.
+	 * @brief Removes every line.
 	 */
-	std::string_view getMessage()
+	void clean()
 	{
-		auto msg = getCDKButtonMessage(_ptr.get());
-		return {reinterpret_cast<char*>(msg)};
+		stream& s = *_stream;
+		s.lines.clear();
+		s.partial.clear();
+		s.flushedFirst = s.lines.first();
+		s.pending = 0;
+		cleanCDKSwindow(_ptr.get());
+		touch();
 	}
 	/**
-	 * @brief Injects a single character into the widget.
-	 * @param input the character to inject into the widget.
-	 * @return
+	 * @brief Lets the user scroll through the window.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
 	 */
+	void activate(chtype* actions)
+	{
+		flush();
+		activateCDKSwindow(_ptr.get(),actions);
+	}
 	int inject(chtype input)
 	{
-		return injectCDKButtonbox (_ptr.get(),input);
+		flush();
+		return injectCDKSwindow(_ptr.get(),input);
+	}
+	void draw(bool box)
+	{
+		flush();
+		if (!defer(box))
+			drawCDKSwindow(_ptr.get(),box);
+	}
+	void erase()
+	{
+		eraseCDKSwindow(_ptr.get());
 	}
 	/**
-	 * @brief set
-	 * @param message
-	 * @param box
+	 * @brief Saves the lines to filename.
+	 * @return the number of lines saved, -1 on error.
 	 */
-	void set(std::string_view message,bool box)
+	int dump(const std::string& filename)
 	{
-		setCDKButton(_ptr.get(),message.data(),box);
+		flush();
+		return dumpCDKSwindow(_ptr.get(),filename.c_str());
 	}
-	void setBackgroundAttrib(chtype attribute)
+	bool getBox()
 	{
-		setCDKButtonBackgroundAttrib (_ptr.get(),attribute);
+		return getCDKSwindowBox(_ptr.get());
 	}
-	void setBackgroundColor(const char* color )
+	/**
+	 * @brief The lines handed to libcdk so far.
+	 */
+	chtype_lines getContents()
 	{
-		setCDKButtonBackgroundColor(_ptr.get(),color);
+		int size;
+		chtype** lines = getCDKSwindowContents(_ptr.get(),&size);
+		return chtype_lines{lines,_ptr->listLen,size};
 	}
-	void setBox(bool box)
+	/**
+	 * @brief Scrolls to line, or TOP or BOTTOM.
+	 */
+	void jumpToLine(int line)
 	{
-		setCDKButtonBox(_ptr.get(), box);
+		flush();
+		jumpToLineCDKSwindow(_ptr.get(),line);
 	}
-	void setBoxAttribute(chtype c)
+	void move(point p,move_options o)
 	{
-		setCDKButtonBoxAttribute(_ptr.get(),c);
+		moveCDKSwindow(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
 	}
-	void setHorizontalChar(chtype c)
+	void position()
 	{
-		setCDKButtonHorizontalChar(_ptr.get(),c);
+		positionCDKSwindow(_ptr.get());
 	}
-	void setLLChar(chtype c)
+	void setBackgroundAttrib(chtype attribute)
 	{
-		setCDKButtonLLChar(_ptr.get(),c);
+		setCDKSwindowBackgroundAttrib(_ptr.get(),attribute);
+		touch();
 	}
-	void setLRChar (chtype c)
+	void setBackgroundColor(const char* color)
 	{
-		setCDKButtonLRChar(_ptr.get(),c);
+		setCDKSwindowBackgroundColor(_ptr.get(),color);
+		touch();
 	}
-	void setMessage(std::string_view message)
+	void setBox(bool box)
 	{
-		setCDKButtonMessage(_ptr.get(),message.data());
+		setCDKSwindowBox(_ptr.get(),box);
+		touch();
 	}
-	void setULChar(chtype c)
+	void setBoxAttribute(chtype character)
 	{
-		setCDKButtonULChar(_ptr.get(),c);
+		setCDKSwindowBoxAttribute(_ptr.get(),character);
+		touch();
 	}
-	void setURChar(chtype c)
+	void setHorizontalChar(chtype character)
 	{
-		setCDKButtonURChar(_ptr.get(),c);
+		setCDKSwindowHorizontalChar(_ptr.get(),character);
+		touch();
 	}
-	void setVerticalChar(chtype c)
+	void setLLChar(chtype character)
 	{
-		setCDKButtonVerticalChar(_ptr.get(),c);
+		setCDKSwindowLLChar(_ptr.get(),character);
+		touch();
 	}
-	/**
-	 * @brief Moves the given widget to the given position.
-	 * @param p The new position of the widget.
-	 * @param o the options
-	 */
-	void move(point p,move_options o)
+	void setLRChar(chtype character)
 	{
-		moveCDKButton(_ptr.get(),
-					  p.x,p.y,
-					  o.relative,o.refresh);
+		setCDKSwindowLRChar(_ptr.get(),character);
+		touch();
 	}
-	/**
-	 * @brief Allows  the user to move the widget around the screen via the cursor/keypad keys.
-	 * @sa cdk_position (3) for key bindings.
-	 */
-	void position()
+	void setPostProcess(PROCESSFN callback,void * data)
 	{
-		positionCDKButton(_ptr.get());
+		setCDKSwindowPostProcess(_ptr.get(),callback,data);
+	}
+	void setPreProcess(PROCESSFN callback,void * data)
+	{
+		setCDKSwindowPreProcess(_ptr.get(),callback,data);
+	}
+	void setULChar(chtype character)
+	{
+		setCDKSwindowULChar(_ptr.get(),character);
+		touch();
+	}
+	void setURChar(chtype character)
+	{
+		setCDKSwindowURChar(_ptr.get(),character);
+		touch();
+	}
+	void setVerticalChar(chtype character)
+	{
+		setCDKSwindowVerticalChar(_ptr.get(),character);
+		touch();
 	}
-	///man cdk_button(3) documents this function but it
-	/// appears that it doesn't exist
-//	void wait(char key)
-//	{
-//		waitCDKButton(_ptr.get(),key);
-//	}
-	EObjectType type{vBUTTON};
 };
 
 /**
- * @brief Text entry widget
+ * @brief Read-only memory mapping of a whole file.
  */
-class text_entry : public widget
+class mapped_file
 {
-	struct deleter
+	const char* _data{nullptr};
+	std::size_t _size{0};
+public:
+	mapped_file() = default;
+	/**
+	 * @throw std::system_error if the file cannot be opened or mapped.
+	 */
+	explicit mapped_file(const std::string& path)
 	{
-		void operator()(CDKENTRY* p)
+		int fd = ::open(path.c_str(),O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			throw std::system_error(errno,std::generic_category(),"mapped_file: cannot open " + path);
+		struct stat info;
+		if (::fstat(fd,&info) != 0)
 		{
-			destroyCDKEntry(p);
+			int error = errno;
+			::close(fd);
+			throw std::system_error(error,std::generic_category(),"mapped_file: cannot stat " + path);
 		}
-	};
-	using entryptr = std::unique_ptr<CDKENTRY,deleter>;
-	entryptr _ptr;
-public:
-	text_entry(screen& parent,point p, std::string_view title,std::string_view label ,
-	           chtype fieldAttribute,
-	           chtype fillerCharacter,
-	           EDisplayType displayType,
-	           int fieldWidth,
-	           int minimumLength,
-	           int maximumLength,
-	           drawing_options o)
-	{
-		_ptr = entryptr(newCDKEntry(parent._ptr.get(),
-		           p.x,p.y,
-		           title.data(),
-		           label.data(),
-		           fieldAttribute,
-		           fillerCharacter,
-		           displayType,
-		           fieldWidth,
-		           minimumLength,
-		           maximumLength,
-		           o.box,
-		           o.shadow));
-		_vptr = _ptr.get();
+		_size = static_cast<std::size_t>(info.st_size);
+		if (_size)
+		{
+			void* p = ::mmap(nullptr,_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if (p == MAP_FAILED)
+			{
+				int error = errno;
+				::close(fd);
+				throw std::system_error(error,std::generic_category(),"mapped_file: cannot map " + path);
+			}
+			::madvise(p,_size,MADV_SEQUENTIAL);
+			_data = static_cast<const char*>(p);
+		}
+		::close(fd);
 	}
-	char* activate(chtype *actions)
+	mapped_file(mapped_file&& other) noexcept
+		:_data(std::exchange(other._data,nullptr)),_size(std::exchange(other._size,0))
+	{}
+	mapped_file& operator=(mapped_file&& other) noexcept
 	{
-		return activateCDKEntry (_ptr.get(),actions);
+		if (this != &other)
+		{
+			this->~mapped_file();
+			_data = std::exchange(other._data,nullptr);
+			_size = std::exchange(other._size,0);
+		}
+		return *this;
 	}
-	void clean()
+	~mapped_file()
 	{
-		cleanCDKEntry(_ptr.get());
+		if (_data)
+			::munmap(const_cast<char*>(_data),_size);
 	}
-	void draw(bool box)
+	std::string_view view() const
 	{
-		drawCDKEntry(_ptr.get(),box);
+		return {_data,_size};
 	}
-	void erase()
+	const char* data() const
 	{
-		eraseCDKEntry (_ptr.get());
+		return _data;
 	}
-	bool getBox()
+	std::size_t size() const
 	{
-		return getCDKEntryBox(_ptr.get());
+		return _size;
 	}
-	chtype getFillerChar ()
+};
+
+/**
+ * @brief Read-only view of a text file of any size.
+ * The file is memory-mapped and indexed by a line_index, the lines
+ * already found can be viewed meanwhile. Only the
+ * lines in the viewport, cut to the width of the widget, are copied
+ * into the libcdk viewer, which is used for drawing only.
+ */
+class file_viewer : public basic_widget<vVIEWER>
+{
+	struct deleter
 	{
-		return getCDKEntryFillerChar(_ptr.get());
-	}
-	chtype getHiddenChar()
+		void operator()(CDKVIEWER* p)
+		{
+			destroyCDKViewer(p);
+		}
+	};
+	using viewerptr = std::unique_ptr<CDKVIEWER,deleter>;
+	/**
+	 * Shared with the updates posted to the screen's update_queue as
+	 * lines are indexed, so the widget may be moved or destroyed
+	 * while indexing.
+	 */
+	struct state
+	{
+		widget target;
+		mapped_file file;
+		std::size_t width{0};
+		std::size_t top{0};
+		std::size_t left{0};
+		std::size_t shown{0};
+		/**
+		 * Declared last so its threads stop first.
+		 */
+		std::unique_ptr<line_index> index;
+
+		std::size_t rows() const
+		{
+			return static_cast<std::size_t>(std::max(static_cast<CDKVIEWER*>(target._vptr)->viewSize,1));
+		}
+		std::string_view lineAt(std::size_t i) const
+		{
+			std::string_view line = index->line(i);
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+			return line;
+		}
+		/**
+		 * Hands the lines in the viewport to libcdk.
+		 */
+		void load()
+		{
+			StringList lines = index->lines(top,rows());
+			for (auto& line : lines)
+			{
+				if (!line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+				line = line.substr(std::min(left,line.size()),width);
+			}
+			cstring_list v(lines);
+			setCDKViewerInfo(static_cast<CDKVIEWER*>(target._vptr),v.data(),v.size(),false);
+			shown = lines.size();
+			target.touch();
+		}
+		/**
+		 * Runs on the UI thread after more lines were indexed.
+		 */
+		void indexed()
+		{
+			if (shown < rows() || index->done())
+				load();
+		}
+	};
+	viewerptr _ptr;
+	std::shared_ptr<state> _state;
+
+	void scrollTo(std::size_t top,std::size_t left)
 	{
-		return getCDKEntryHiddenChar(_ptr.get());
+		state& s = *_state;
+		std::size_t count = s.index->lineCount();
+		s.top = std::min(top,count > s.rows() ? count - s.rows() : 0);
+		s.left = left;
+		s.load();
 	}
-	int getMax()
-	{
-		return getCDKEntryMax(_ptr.get());
+public:
+	file_viewer() = default;
+	/**
+	 * @brief Maps path and starts indexing its lines in the background.
+	 * @throw std::system_error if the file cannot be mapped.
+	 */
+	file_viewer(screen& parent, point p, widget_size size,
+	            const std::string& path,
+	            std::string_view title,
+	            drawing_options o)
+	{
+		auto s = std::make_shared<state>();
+		s->file = mapped_file(path);
+		s->width = static_cast<std::size_t>(std::max(size.width,1));
+		_ptr = viewerptr(newCDKViewer(parent._ptr.get(),
+		                              p.x,p.y,
+		                              size.height,
+		                              size.width,
+		                              nullptr,0,
+		                              A_REVERSE,
+		                              o.box,
+		                              o.shadow));
+		setCDKViewer(_ptr.get(),std::string(title).c_str(),nullptr,0,A_REVERSE,false,false,o.box);
+		_vptr = _ptr.get();
+		_screen = &parent;
+		s->target = *this;
+		_state = s;
+		s->index = std::make_unique<line_index>(s->file.view(),
+		                                        [&parent,key = s.get(),self = std::weak_ptr<state>(s)]{
+			parent.updates().post(key,update_queue::custom,0,[self]{
+				if (auto shared = self.lock())
+					shared->indexed();
+			});
+		});
 	}
-	int getMin()
+	/**
+	 * @brief Lets the user scroll through the file.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return the first line shown or -1 if escape was pressed.
+	 */
+	long activate(chtype* actions)
 	{
-		return getCDKEntryMin(_ptr.get());
+		ObjOf(_ptr.get())->exitType = vNEVER_ACTIVATED;
+		draw(ObjOf(_ptr.get())->box);
+		if (actions)
+		{
+			for (; *actions; ++actions)
+			{
+				long ret = inject(*actions);
+				if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+					return ret;
+			}
+			return -1;
+		}
+		WINDOW* win = ObjOf(_ptr.get())->inputWindow ? ObjOf(_ptr.get())->inputWindow : _ptr->win;
+		keypad(win,TRUE);
+		for (;;)
+		{
+			long ret = inject(static_cast<chtype>(wgetch(win)));
+			if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+				return ret;
+		}
+	}
+	/**
+	 * @brief Injects a single key into the widget.
+	 * @return the first line shown on RETURN or TAB, otherwise -1.
+	 */
+	long inject(chtype input)
+	{
+		auto obj = ObjOf(_ptr.get());
+		obj->exitType = vEARLY_EXIT;
+		state& s = *_state;
+		std::size_t page = s.rows() > 1 ? s.rows() - 1 : 1;
+		std::size_t step = s.width > 1 ? s.width / 2 : 1;
+		switch (input)
+		{
+		case KEY_UP:
+			scrollTo(s.top ? s.top - 1 : 0,s.left);
+			break;
+		case KEY_DOWN:
+			scrollTo(s.top + 1,s.left);
+			break;
+		case KEY_PPAGE:
+			scrollTo(s.top > page ? s.top - page : 0,s.left);
+			break;
+		case KEY_NPAGE:
+		case ' ':
+			scrollTo(s.top + page,s.left);
+			break;
+		case KEY_HOME:
+			scrollTo(0,0);
+			break;
+		case KEY_END:
+			scrollTo(static_cast<std::size_t>(-1),s.left);
+			break;
+		case KEY_LEFT:
+			scrollTo(s.top,s.left > step ? s.left - step : 0);
+			break;
+		case KEY_RIGHT:
+			scrollTo(s.top,s.left + step);
+			break;
+		case KEY_ENTER:
+		case KEY_RETURN:
+		case KEY_TAB:
+			obj->exitType = vNORMAL;
+			return static_cast<long>(s.top);
+		case KEY_ESC:
+			obj->exitType = vESCAPE_HIT;
+			return -1;
+		default:
+			break;
+		}
+		if (!defer())
+			drawCDKViewer(_ptr.get(),obj->box);
+		return -1;
 	}
-	char* getValue()
+	/**
+	 * @brief Makes line the first one shown.
+	 */
+	void setTopLine(std::size_t line)
 	{
-		return getCDKEntryValue (_ptr.get());
+		scrollTo(line,_state->left);
 	}
-
-	char* inject(chtype input)
+	std::size_t getTopLine() const
 	{
-		return injectCDKEntry (_ptr.get(),input);
+		return _state->top;
 	}
-
-	void move(point p,move_options o)
+	/**
+	 * @brief Lines found so far, the total once isIndexed.
+	 */
+	std::size_t lineCount() const
 	{
-		moveCDKEntry (_ptr.get(),
-		                p.x,p.y,
-		                o.relative,
-		                o.refresh);
+		return _state->index->lineCount();
 	}
-	void position()
+	/**
+	 * @brief Whether all the lines of the file were found.
+	 */
+	bool isIndexed() const
 	{
-		positionCDKEntry(_ptr.get());
+		return _state->index->done();
 	}
-
-	void set(std::string_view value,
-	        int minimumLength,
-	        int maximumLength,
-	        bool box)
+	/**
+	 * @brief Line i of the file, valid while the widget lives.
+	 */
+	std::string_view line(std::size_t i) const
 	{
-		setCDKEntry(_ptr.get(),
-		            value.data(),
-		            minimumLength,
-		            maximumLength,
-		            box);
+		return _state->lineAt(i);
 	}
-	void setBackgroundAttrib(chtype attribute)
+	const line_index& index() const
 	{
-		setCDKEntryBackgroundAttrib(_ptr.get(),attribute);
+		return *_state->index;
 	}
-	void setBackgroundColor(const char * color)
+	/**
+	 * @brief Shows the indexing progress in l, see line_index::setProgressLabel.
+	 */
+	void setProgressLabel(label* l)
 	{
-		setCDKEntryBackgroundColor(_ptr.get(),color);
+		_state->index->setProgressLabel(l);
 	}
-	void setBox(bool box)
+	void draw(bool box)
 	{
-		setCDKEntryBox(_ptr.get(),box);
+		if (!defer(box))
+			drawCDKViewer(_ptr.get(),box);
 	}
-	void setBoxAttribute (chtype character)
+	void erase()
 	{
-		setCDKEntryBoxAttribute(_ptr.get(),character);
+		eraseCDKViewer(_ptr.get());
 	}
-	void setCB(ENTRYCB callBackFunction)
+	bool getBox()
 	{
-		setCDKEntryCB (_ptr.get(),callBackFunction);
+		return getCDKViewerBox(_ptr.get());
 	}
-
-	void setFillerChar(chtype character)
+	void move(point p,move_options o)
 	{
-		setCDKEntryFillerChar(_ptr.get(),character);
+		moveCDKViewer(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
 	}
-
-	void setHiddenChar(chtype character)
+	void position()
 	{
-		setCDKEntryHiddenChar (_ptr.get(),character);
+		positionCDKViewer(_ptr.get());
 	}
-
-	void setHighlight (chtype highlight,bool cursor)
+	void setTitle(std::string_view title)
 	{
-		setCDKEntryHighlight (_ptr.get(),highlight,cursor);
+		setCDKViewerTitle(_ptr.get(),std::string(title).c_str());
+		touch();
 	}
-	void setHorizontalChar(chtype character)
+	void setBackgroundAttrib(chtype attribute)
 	{
-		setCDKEntryHorizontalChar (_ptr.get(),character);
+		setCDKViewerBackgroundAttrib(_ptr.get(),attribute);
+		touch();
 	}
-	void setLLChar(chtype character)
+	void setBackgroundColor(const char* color)
 	{
-		setCDKEntryLLChar (_ptr.get(),character);
+		setCDKViewerBackgroundColor(_ptr.get(),color);
+		touch();
 	}
-
-	void setLRChar(chtype character)
+	void setBox(bool box)
 	{
-		setCDKEntryLRChar(_ptr.get(),character);
+		setCDKViewerBox(_ptr.get(),box);
+		touch();
 	}
-	void setMax(int maximum)
+	void setBoxAttribute(chtype character)
 	{
-		setCDKEntryMax(_ptr.get(),maximum);
+		setCDKViewerBoxAttribute(_ptr.get(),character);
+		touch();
 	}
-	void setMin(int minimum)
+	void setHorizontalChar(chtype character)
 	{
-		setCDKEntryMin(_ptr.get(),minimum);
+		setCDKViewerHorizontalChar(_ptr.get(),character);
+		touch();
 	}
-
-	void setPostProcess(PROCESSFN callback,void * data)
+	void setLLChar(chtype character)
 	{
-		setCDKEntryPostProcess (_ptr.get(),callback,data);
+		setCDKViewerLLChar(_ptr.get(),character);
+		touch();
 	}
-	void setPreProcess(PROCESSFN callback,void * data)
+	void setLRChar(chtype character)
 	{
-		setCDKEntryPreProcess (_ptr.get(),callback,data);
+		setCDKViewerLRChar(_ptr.get(),character);
+		touch();
 	}
 	void setULChar(chtype character)
 	{
-		setCDKEntryULChar(_ptr.get(),character);
+		setCDKViewerULChar(_ptr.get(),character);
+		touch();
 	}
 	void setURChar(chtype character)
 	{
-		setCDKEntryURChar(_ptr.get(),character);
-	}
-	void setValue(std::string_view value)
-	{
-		setCDKEntryValue(_ptr.get(),value.data());
+		setCDKViewerURChar(_ptr.get(),character);
+		touch();
 	}
-	void setVerticalChar (chtype character)
+	void setVerticalChar(chtype character)
 	{
-		setCDKEntryVerticalChar(_ptr.get(),character);
+		setCDKViewerVerticalChar(_ptr.get(),character);
+		touch();
 	}
-
-	EObjectType type{vENTRY};
 };
 
 /**
- * @brief Sorted list widget.
- * alpha_list allows a user to select from a list of alphabetically sorted words.  The
-	   user can use the arrow keys to traverse through the list or type in the beginning  of  the
-	   word  and  the list will automatically adjust itself in the correct place in the scrolling
-	   list.  This widget, like the file selector widget, is a compound widget of both the  entry
-	   field widget and the scrolling list widget.
+ * @brief Editable table whose cells are kept in a sparse store.
+ * Only the populated cells are stored, in a hash map, and the libcdk
+ * matrix holds just the rows in the viewport. Moving past its first or
+ * last row, or paging, writes the viewport back to the store and
+ * loads the next rows. Rows and columns are numbered from 0.
  */
-class alpha_list : public widget
+class matrix : public basic_widget<vMATRIX>
 {
 	struct deleter
 	{
-		void operator()(CDKALPHALIST* p)
+		void operator()(CDKMATRIX* p)
 		{
-			destroyCDKAlphalist(p);
+			destroyCDKMatrix(p);
 		}
 	};
-	using alphalistptr = std::unique_ptr<CDKALPHALIST,deleter>;
-	alphalistptr _ptr;
-public:
-	alpha_list() = default;
-
+	using matrixptr = std::unique_ptr<CDKMATRIX,deleter>;
+	matrixptr _ptr;
+	std::unordered_map<std::uint64_t,std::string> _cells;
+	/**
+	 * Width of each column, libcdk keeps no more of a value.
+	 */
+	std::vector<int> _widths;
+	std::size_t _rows{0};
+	std::size_t _cols{0};
+	std::size_t _top{0};
+	int _viewRows{0};
+	/**
+	 * 1 when the first libcdk column holds the row numbers.
+	 */
+	int _first{0};
 
-	alpha_list(screen& parent, point p, widget_size size,
-	        std::string_view title,
-	        std::string_view  label,
-	        StringList list,
-	        chtype fillerCharacter,
-	        chtype highlight,
-	        drawing_options o)
-	{
-		_ptr = alphalistptr(newCDKAlphalist (
-		           parent._ptr.get(),
-		           p.x,
-		           p.y,
-		           size.height,
-		           size.width,
-		           title.data(),
-		           label.data(),
-		           transformStringList( list).data(),
-		           list.size(),
-		           fillerCharacter,
-		           highlight,
-		           o.box,
-		           o.shadow));
-		_vptr = _ptr.get();
-	}
-	std::string activate(chtype* actions)
+	std::uint64_t key(std::size_t row,std::size_t col) const
 	{
-		return std::string(activateCDKAlphalist(_ptr.get(),actions));
+		return static_cast<std::uint64_t>(row) * _cols + col;
 	}
-	void draw(bool box)
+	/**
+	 * Writes the cells in the viewport back to the store.
+	 */
+	void sync()
 	{
-		drawCDKAlphalist(_ptr.get(),box);
+		for (int r = 1; r <= _viewRows; ++r)
+		{
+			for (std::size_t c = 0; c < _cols; ++c)
+			{
+				const char* value = getCDKMatrixCell(_ptr.get(),r,static_cast<int>(c) + 1 + _first);
+				std::uint64_t k = key(_top + static_cast<std::size_t>(r) - 1,c);
+				if (value && *value)
+				{
+					auto it = _cells.find(k);
+					if (it == _cells.end())
+						_cells.emplace(k,value);
+					else if (it->second != value)
+						it->second = value;
+				}
+				else
+				{
+					_cells.erase(k);
+				}
+			}
+		}
 	}
-	void erase()
+	/**
+	 * Loads the rows from top into the libcdk matrix.
+	 */
+	void load(std::size_t top)
 	{
-		eraseCDKAlphalist(_ptr.get());
+		_top = top;
+		cleanCDKMatrix(_ptr.get());
+		for (int r = 1; r <= _viewRows; ++r)
+		{
+			std::size_t row = _top + static_cast<std::size_t>(r) - 1;
+			if (_first)
+				setCDKMatrixCell(_ptr.get(),r,1,std::to_string(row + 1).c_str());
+			for (std::size_t c = 0; c < _cols; ++c)
+			{
+				auto it = _cells.find(key(row,c));
+				if (it != _cells.end())
+					setCDKMatrixCell(_ptr.get(),r,static_cast<int>(c) + 1 + _first,it->second.c_str());
+			}
+		}
 	}
-	bool getBox()
+	void scrollTo(std::size_t top)
 	{
-		return getCDKAlphalistBox(_ptr.get());
+		top = std::min(top,_rows - static_cast<std::size_t>(_viewRows));
+		if (top == _top)
+			return;
+		sync();
+		load(top);
+		if (!defer())
+			drawCDKMatrix(_ptr.get(),ObjOf(_ptr.get())->box);
 	}
-	StringList getContents()
+	/**
+	 * Moves the current cell to row, keeping it on the same row of the
+	 * viewport while the table can scroll, as libcdk pages.
+	 */
+	void pageTo(std::size_t row)
 	{
-		int items;
-		char** contents = getCDKAlphalistContents (_ptr.get(),&items);
-		return transformCharPtrPtr(contents,items);
+		std::size_t viewRow = static_cast<std::size_t>(getCDKMatrixRow(_ptr.get())) - 1;
+		int col = getCDKMatrixCol(_ptr.get());
+		if (row == _top + viewRow)
+		{
+			beep();
+			return;
+		}
+		scrollTo(row > viewRow ? row - viewRow : 0);
+		moveToCDKMatrixCell(_ptr.get(),static_cast<int>(row - _top) + 1,col);
+		touch();
 	}
-	int getCurrentItem()
+	/**
+	 * Whether inject scrolls the table for input instead of giving it to libcdk.
+	 */
+	bool scrolls(chtype input)
 	{
-		return getCDKAlphalistCurrentItem(_ptr.get());
+		int row = getCDKMatrixRow(_ptr.get());
+		switch (input)
+		{
+		case KEY_UP:
+			return row == 1 && _top;
+		case KEY_DOWN:
+			return row == _viewRows && _top + static_cast<std::size_t>(_viewRows) < _rows;
+		case KEY_PPAGE:
+		case KEY_NPAGE:
+			return true;
+		}
+		return false;
 	}
-	chtype getFillerChar()
-	{
-		return getCDKAlphalistFillerChar (_ptr.get());
+public:
+	matrix() = default;
+	/**
+	 * @param rows number of rows of the table, at least 1.
+	 * @param viewRows rows shown at once.
+	 * @param viewCols columns shown at once, libcdk scrolls them.
+	 * @param columnTitles one title per column.
+	 * @param columnWidths one width per column.
+	 * @param columnTypes one display type per column.
+	 * @param numbers show the row numbers in an extra first column.
+	 * @throw std::invalid_argument if columnTitles is empty.
+	 */
+	matrix(screen& parent, point p,
+	       std::size_t rows,
+	       int viewRows, int viewCols,
+	       std::string_view title,
+	       const StringList& columnTitles,
+	       const std::vector<int>& columnWidths,
+	       const std::vector<EDisplayType>& columnTypes,
+	       bool numbers,
+	       drawing_options o)
+		:_rows(std::max<std::size_t>(rows,1)),_cols(columnTitles.size()),_first(numbers ? 1 : 0)
+	{
+		if (!_cols)
+			throw std::invalid_argument("matrix: at least one column title is needed");
+		_viewRows = static_cast<int>(std::min<std::size_t>(static_cast<std::size_t>(std::max(viewRows,1)),_rows));
+		int cols = static_cast<int>(_cols) + _first;
+		//libcdk reads these from index 1
+		std::vector<std::string> titles(static_cast<std::size_t>(cols) + 1);
+		std::vector<int> widths(titles.size());
+		std::vector<int> types(titles.size());
+		if (_first)
+		{
+			titles[1] = "#";
+			widths[1] = static_cast<int>(std::to_string(_rows).size());
+			types[1] = vVIEWONLY;
+		}
+		_widths.resize(_cols);
+		for (std::size_t c = 0; c < _cols; ++c)
+		{
+			_widths[c] = c < columnWidths.size() ? std::max(columnWidths[c],1) : 1;
+			titles[c + 1 + _first] = std::string(columnTitles[c]);
+			widths[c + 1 + _first] = _widths[c];
+			types[c + 1 + _first] = c < columnTypes.size() ? columnTypes[c] : vMIXED;
+		}
+		std::vector<std::string> rowTitles(static_cast<std::size_t>(_viewRows) + 1);
+		cstring_list columnList(StringList(titles.begin(),titles.end()));
+		cstring_list rowList(StringList(rowTitles.begin(),rowTitles.end()));
+		_ptr = matrixptr(newCDKMatrix(parent._ptr.get(),
+		                              p.x,p.y,
+		                              _viewRows,cols,
+		                              _viewRows,std::min(std::max(viewCols,1),cols),
+		                              std::string(title).c_str(),
+		                              rowList.data(),
+		                              columnList.data(),
+		                              widths.data(),
+		                              types.data(),
+		                              1,1,
+		                              '.',
+		                              NONE,
+		                              o.box,
+		                              true,
+		                              o.shadow));
+		_vptr = _ptr.get();
+		_screen = &parent;
+		load(0);
 	}
-	chtype getHighlight()
+	/**
+	 * @brief Lets the user edit the table.
+	 * @param actions if non-NULL, the keys, terminated by 0, are injected
+	 * instead of reading the keyboard.
+	 * @return 1 if the user left with RETURN, -1 if with escape.
+	 */
+	int activate(chtype* actions)
 	{
-		return getCDKAlphalistHighlight(_ptr.get());
+		ObjOf(_ptr.get())->exitType = vNEVER_ACTIVATED;
+		draw(ObjOf(_ptr.get())->box);
+		if (actions)
+		{
+			for (; *actions; ++actions)
+			{
+				int ret = inject(*actions);
+				if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+					return ret;
+			}
+			return -1;
+		}
+		WINDOW* win = ObjOf(_ptr.get())->inputWindow ? ObjOf(_ptr.get())->inputWindow : _ptr->win;
+		keypad(win,TRUE);
+		for (;;)
+		{
+			int ret = inject(static_cast<chtype>(wgetch(win)));
+			if (ObjOf(_ptr.get())->exitType != vEARLY_EXIT)
+				return ret;
+		}
 	}
-	char* inject(chtype input)
+	/**
+	 * @brief Injects a single key into the widget.
+	 * Vertical movement past the viewport and the page keys scroll the
+	 * table, other keys go to libcdk. As in libcdk the pre-process hook
+	 * runs first and can reject the key, then the key bindings, then
+	 * the post-process hook.
+	 */
+	int inject(chtype input)
 	{
-		return injectCDKAlphalist(_ptr.get(),input);
+		auto obj = ObjOf(_ptr.get());
+		if (!scrolls(input))
+		{
+			int ret = injectCDKMatrix(_ptr.get(),input);
+			if (obj->exitType != vEARLY_EXIT)
+				sync();
+			return ret;
+		}
+		obj->exitType = vEARLY_EXIT;
+		if (obj->preProcessFunction && !obj->preProcessFunction(vMATRIX,_ptr.get(),obj->preProcessData,input))
+			return -1;
+		if (checkCDKObjectBind(vMATRIX,_ptr.get(),input))
+			return -1;
+		std::size_t row = getRow();
+		std::size_t page = _viewRows > 1 ? static_cast<std::size_t>(_viewRows) - 1 : 1;
+		switch (input)
+		{
+		case KEY_UP:
+			scrollTo(_top - 1);
+			break;
+		case KEY_DOWN:
+			scrollTo(_top + 1);
+			break;
+		case KEY_PPAGE:
+			pageTo(row > page ? row - page : 0);
+			break;
+		case KEY_NPAGE:
+			pageTo(std::min(row + page,_rows - 1));
+			break;
+		}
+		if (obj->postProcessFunction)
+			obj->postProcessFunction(vMATRIX,_ptr.get(),obj->postProcessData,input);
+		return -1;
 	}
-	void move(point p,move_options o)
+	/**
+	 * @brief Value of a cell, empty if it was never set.
+	 */
+	std::string getCell(std::size_t row,std::size_t col)
 	{
-		moveCDKAlphalist(_ptr.get(), p.x, p.y, o.relative, o.refresh);
+		if (row >= _top && row < _top + static_cast<std::size_t>(_viewRows) && col < _cols)
+		{
+			const char* value = getCDKMatrixCell(_ptr.get(),
+			                                     static_cast<int>(row - _top) + 1,
+			                                     static_cast<int>(col) + 1 + _first);
+			return value ? value : "";
+		}
+		auto it = _cells.find(key(row,col));
+		return it == _cells.end() ? std::string() : it->second;
 	}
-	void position()
-	{
-		positionCDKAlphalist(_ptr.get());
+	/**
+	 * @brief Sets a cell, an empty value removes it from the store.
+	 * The value is cut to the width of the column, as libcdk cuts it.
+	 */
+	void setCell(std::size_t row,std::size_t col,std::string_view value)
+	{
+		if (row >= _rows || col >= _cols)
+			return;
+		value = value.substr(0,static_cast<std::size_t>(_widths[col]));
+		if (value.empty())
+			_cells.erase(key(row,col));
+		else
+			_cells[key(row,col)] = std::string(value);
+		if (row >= _top && row < _top + static_cast<std::size_t>(_viewRows))
+		{
+			setCDKMatrixCell(_ptr.get(),
+			                 static_cast<int>(row - _top) + 1,
+			                 static_cast<int>(col) + 1 + _first,
+			                 std::string(value).c_str());
+			touch();
+		}
 	}
-	void set(StringList list,chtype fillerCharacter,chtype highlight,bool box)
+	/**
+	 * @brief Empties every cell.
+	 */
+	void clean()
 	{
-		setCDKAlphalist(_ptr.get(),
-		        transformStringList(list).data(),
-		        list.size(),
-		        fillerCharacter,
-		        highlight,
-		        box);
+		_cells.clear();
+		load(_top);
+		touch();
 	}
-	void setBackgroundAttrib(chtype attribute)
+	/**
+	 * @brief Calls f(row, col, value) for every populated cell, in no particular order.
+	 */
+	template<class F>
+	void forEachCell(F&& f)
 	{
-		setCDKAlphalistBackgroundAttrib (_ptr.get(),attribute);
+		sync();
+		for (auto& cell : _cells)
+			f(static_cast<std::size_t>(cell.first / _cols),static_cast<std::size_t>(cell.first % _cols),std::string_view(cell.second));
 	}
-	void setBackgroundColor (const char* color)
+	/**
+	 * @brief Number of populated cells.
+	 */
+	std::size_t cellCount()
 	{
-		setCDKAlphalistBackgroundColor(_ptr.get(),color);
+		sync();
+		return _cells.size();
 	}
-	void setBox(bool box)
+	std::size_t rows() const
 	{
-		setCDKAlphalistBox(_ptr.get(),box);
+		return _rows;
 	}
-	void setBoxAttribute(chtype character)
+	std::size_t cols() const
 	{
-		setCDKAlphalistBoxAttribute(_ptr.get(),character);
+		return _cols;
 	}
-	void setContents (StringList c)
+	/**
+	 * @brief Row of the current cell.
+	 */
+	std::size_t getRow()
 	{
-		setCDKAlphalistContents(_ptr.get(),transformStringList(c).data(),c.size());
+		return _top + static_cast<std::size_t>(getCDKMatrixRow(_ptr.get())) - 1;
 	}
-	void setCurrentItem(int item)
+	/**
+	 * @brief Column of the current cell, 0 also while on the row numbers.
+	 */
+	std::size_t getCol()
 	{
-		setCDKAlphalistCurrentItem (_ptr.get(),item);
+		return static_cast<std::size_t>(std::max(getCDKMatrixCol(_ptr.get()) - 1 - _first,0));
 	}
-	void setFillerChar(chtype fillerCharacter)
+	/**
+	 * @brief Makes (row, col) the current cell, scrolling to it if needed.
+	 */
+	void moveToCell(std::size_t row,std::size_t col)
 	{
-		setCDKAlphalistFillerChar(_ptr.get(),fillerCharacter);
+		if (row >= _rows || col >= _cols)
+			return;
+		std::size_t page = static_cast<std::size_t>(_viewRows);
+		if (row < _top)
+			scrollTo(row);
+		else if (row >= _top + page)
+			scrollTo(row + 1 - page);
+		moveToCDKMatrixCell(_ptr.get(),static_cast<int>(row - _top) + 1,static_cast<int>(col) + 1 + _first);
 	}
-	void setHighlight(chtype highlight)
+	void draw(bool box)
 	{
-		setCDKAlphalistHighlight (_ptr.get(),highlight);
+		if (!defer(box))
+			drawCDKMatrix(_ptr.get(),box);
 	}
-	void setHorizontalChar(chtype character)
+	void erase()
 	{
-		setCDKAlphalistHorizontalChar (_ptr.get(),character);
+		eraseCDKMatrix(_ptr.get());
 	}
-	void setLLChar(chtype character)
+	bool getBox()
 	{
-		setCDKAlphalistLLChar(_ptr.get(),character);
+		return getCDKMatrixBox(_ptr.get());
 	}
-	void setLRChar(chtype character)
+	void move(point p,move_options o)
 	{
-		setCDKAlphalistLRChar(_ptr.get(),character);
+		moveCDKMatrix(_ptr.get(), p.x, p.y, o.relative, o.refresh && !defer());
 	}
-	void setPostProcess (PROCESSFN callback,void * data)
+	void position()
 	{
-		setCDKAlphalistPostProcess (_ptr.get(),callback, data);
+		positionCDKMatrix(_ptr.get());
 	}
-	void setPreProcess(PROCESSFN callback,void * data)
+	void setBackgroundAttrib(chtype attribute)
 	{
-		setCDKAlphalistPreProcess(_ptr.get(),callback,data);
+		setCDKMatrixBackgroundAttrib(_ptr.get(),attribute);
+		touch();
 	}
-	void setULChar(chtype character)
+	void setBoxAttribute(chtype character)
 	{
-		setCDKAlphalistULChar (_ptr.get(),character);
+		setCDKMatrixBoxAttribute(_ptr.get(),character);
+		touch();
 	}
-	void setURChar(chtype character)
+	void setPostProcess(PROCESSFN callback,void * data)
 	{
-		setCDKAlphalistURChar (_ptr.get(),character);
+		setCDKMatrixPostProcess(_ptr.get(),callback,data);
 	}
-	void setVerticalChar(chtype character)
+	void setPreProcess(PROCESSFN callback,void * data)
 	{
-		setCDKAlphalistVerticalChar(_ptr.get(),character);
+		setCDKMatrixPreProcess(_ptr.get(),callback,data);
 	}
-
-
-	EObjectType type{vALPHALIST};
 };
 
 struct date {
@@ -942,7 +6302,7 @@ struct date_attributes
 /**
  * @brief The calendar class curses calendar widget.
  */
-class calendar : public widget
+class calendar : public basic_widget<vCALENDAR>
 {
 	struct deleter
 	{
@@ -953,6 +6313,12 @@ class calendar : public widget
 	};
 	using calendarptr = std::unique_ptr<CDKCALENDAR,deleter>;
 	calendarptr _ptr;
+	/**
+	 * Names passed to setMonthsNames, libcdk keeps the pointers
+	 * instead of copying them.
+	 */
+	std::vector<std::string> _monthNames;
+	std::vector<char*> _monthPointers;
 public:
 	/**Empty constructor
 	  */
@@ -970,7 +6336,7 @@ public:
 	 * @param o drawing options
 	 * @sa drawing_options point
 	 */
-	calendar(screen parent,
+	calendar(screen& parent,
 	         point p,
 	         std::string_view title,
 	         date d,
@@ -991,6 +6357,7 @@ public:
 		                                o.box,
 		                                o.shadow));
 		_vptr = _ptr.get();
+		_screen = &parent;
 
 	}
 	/**
@@ -1016,7 +6383,8 @@ public:
 	 */
 	void draw(bool box)
 	{
-		drawCDKCalendar (_ptr.get(),box);
+		if (!defer(box))
+			drawCDKCalendar (_ptr.get(),box);
 	}
 	/**
 	 * @brief removes  the  widget  from  the screen.  This does NOT destroy the
@@ -1115,7 +6483,7 @@ public:
 	{
 		moveCDKCalendar(_ptr.get(),
 		                p.x,p.y,
-		                o.relative,o.refresh);
+		                o.relative,o.refresh && !defer());
 	}
 	/**
 	 * @brief allows  the user to move the widget around the screen via the cursor/keypad keys.
@@ -1134,6 +6502,7 @@ public:
 		                   d.day,
 		                   d.month,
 		                   d.year);
+		touch();
 	}
 	/**
 	 * @brief lets the programmer modify elements of an existing calendar widget.
@@ -1153,22 +6522,27 @@ public:
 		                   attr.year,
 		                   highlight,
 		                   box);
+		touch();
 	}
 	void setBackgroundAttrib (chtype attribute)
 	{
 		setCDKCalendarBackgroundAttrib (_ptr.get(),attribute);
+		touch();
 	}
 	void setBackgroundColor(std::string_view color)
 	{
 		setCDKCalendarBackgroundColor(_ptr.get(),color.data());
+		touch();
 	}
 	void setBox(bool box)
 	{
 		setCDKCalendarBox (_ptr.get(),box);
+		touch();
 	}
 	void setBoxAttribute(chtype ch)
 	{
 		setCDKCalendarBoxAttribute (_ptr.get(),ch);
+		touch();
 	}
 	void setDate(date d)
 	{
@@ -1176,30 +6550,37 @@ public:
 		                   d.day,
 		                   d.month,
 		                   d.year);
+		touch();
 	}
 	void setDayAttribute (chtype attribute)
 	{
 		setCDKCalendarDayAttribute (_ptr.get(),attribute);
+		touch();
 	}
 	void setDaysNames(std::string_view days)
 	{
 		setCDKCalendarDaysNames (_ptr.get(),days.data());
+		touch();
 	}
 	void setHighlight (chtype attribute)
 	{
 		setCDKCalendarHighlight(_ptr.get(),attribute);
+		touch();
 	}
 	void setHorizontalChar(chtype ch)
 	{
 		setCDKCalendarHorizontalChar(_ptr.get(),ch);
+		touch();
 	}
 	void setLLChar(chtype ch)
 	{
 		setCDKCalendarLLChar(_ptr.get(),ch);
+		touch();
 	}
 	void setLRChar (chtype ch)
 	{
 		setCDKCalendarLRChar(_ptr.get(),ch);
+		touch();
 	}
 	/**
 	 * @brief allows the user to set a marker which will be displayed when the month is drawn.
@@ -1214,14 +6595,43 @@ public:
 		                   d.month,
 		                   d.year,
 		                   marker);
+		touch();
+	}
+	/**
+	 * @brief Thread-safe setMarker, applied on the next refresh.
+	 * The calendar may be moved meanwhile, the update is dropped if it
+	 * is destroyed.
+	 */
+	void postMarker(date d,chtype marker)
+	{
+		if (!_screen)
+			return;
+		long day = (static_cast<long>(d.year) * 12 + d.month) * 31 + d.day;
+		_screen->updates().post(_vptr,update_queue::marker,day,
+		                        [p = _ptr.get(),s = _screen,d,marker]{
+			setCDKCalendarMarker(p,d.day,d.month,d.year,marker);
+			s->markObject(p);
+		});
 	}
 	void setMonthAttribute(chtype attribute)
 	{
 		setCDKCalendarMonthAttribute(_ptr.get(),attribute);
+		touch();
 	}
-	void setMonthsNames(StringList months)
+	/**
+	 * @brief Sets the month names, months[1] to months[12] are used.
+	 * @throw std::invalid_argument if months has less than 13 entries.
+	 */
+	void setMonthsNames(const StringList& months)
 	{
-		setCDKCalendarMonthsNames(_ptr.get(),transformStringList( months).data());
+		if (months.size() < 13)
+			throw std::invalid_argument("calendar: setMonthsNames needs 13 names");
+		_monthNames.assign(months.begin(),months.end());
+		_monthPointers.clear();
+		for (auto& name : _monthNames)
+			_monthPointers.push_back(name.data());
+		setCDKCalendarMonthsNames(_ptr.get(),_monthPointers.data());
+		touch();
 	}
 	void setPostProcess(PROCESSFN callback,void * data)
 	{
@@ -1234,22 +6644,25 @@ public:
 	void setULChar(chtype ch)
 	{
 		setCDKCalendarULChar(_ptr.get(),ch);
+		touch();
 	}
 	void setURChar(chtype ch)
 	{
 		setCDKCalendarURChar (_ptr.get(),ch);
+		touch();
 	}
 	void setVerticalChar(chtype ch)
 	{
 		setCDKCalendarVerticalChar(_ptr.get(),ch);
+		touch();
 	}
 
 	void setYearAttribute(chtype attribute)
 	{
 		setCDKCalendarYearAttribute (_ptr.get(),attribute);
+		touch();
 	}
 
-	EObjectType type{vCALENDAR};
 };
 
 }//namespace cdk
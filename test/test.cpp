@@ -0,0 +1,493 @@
+#include "../cdk.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <deque>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+cdk::headless_terminal& terminal()
+{
+	static cdk::headless_terminal term(120,40);
+	return term;
+}
+
+std::mt19937& rng()
+{
+	static std::mt19937 gen(12345);
+	return gen;
+}
+
+std::size_t randomBelow(std::size_t n)
+{
+	return std::uniform_int_distribution<std::size_t>(0,n - 1)(rng());
+}
+
+std::string randomString(std::size_t maxLength,std::string_view alphabet)
+{
+	std::string s(randomBelow(maxLength + 1),' ');
+	for (auto& c : s)
+		c = alphabet[randomBelow(alphabet.size())];
+	return s;
+}
+
+std::vector<std::string> randomStrings(std::size_t count,std::size_t maxLength,std::string_view alphabet)
+{
+	std::vector<std::string> items(count);
+	for (auto& item : items)
+		item = randomString(maxLength,alphabet);
+	return items;
+}
+
+std::vector<std::string> strings(const cdk::StringList& views)
+{
+	return std::vector<std::string>(views.begin(),views.end());
+}
+
+/**
+ * Lines of text the way line_index counts them, the last one only if
+ * it is not empty.
+ */
+std::vector<std::string_view> naiveLines(std::string_view text)
+{
+	std::vector<std::string_view> lines;
+	std::size_t start = 0;
+	for (std::size_t i = 0; i < text.size(); ++i)
+	{
+		if (text[i] == '\n')
+		{
+			lines.push_back(text.substr(start,i - start));
+			start = i + 1;
+		}
+	}
+	if (start < text.size())
+		lines.push_back(text.substr(start));
+	return lines;
+}
+
+}
+
+TEST(update_queue,keeps_the_last_update_of_each_key)
+{
+	cdk::update_queue q;
+	int targets[3];
+	struct posted
+	{
+		const void* target;
+		int kind;
+		long detail;
+		int id;
+	};
+	for (int round = 0; round < 50; ++round)
+	{
+		std::vector<posted> all;
+		std::vector<int> applied;
+		for (int id = 0; id < 200; ++id)
+		{
+			const void* target = randomBelow(4) ? &targets[randomBelow(3)] : nullptr;
+			posted p{target,static_cast<int>(randomBelow(2)),static_cast<long>(randomBelow(3)),id};
+			all.push_back(p);
+			q.post(p.target,p.kind,p.detail,[&applied,id]{ applied.push_back(id); });
+		}
+		//naive reference: an update survives unless a later one has its key
+		std::vector<int> expected;
+		for (std::size_t i = 0; i < all.size(); ++i)
+		{
+			bool replaced = false;
+			for (std::size_t j = i + 1; j < all.size() && all[i].target && !replaced; ++j)
+			{
+				replaced = all[j].target == all[i].target && all[j].kind == all[i].kind
+				        && all[j].detail == all[i].detail;
+			}
+			if (!replaced)
+				expected.push_back(all[i].id);
+		}
+		EXPECT_EQ(q.drain(),expected.size());
+		EXPECT_EQ(applied,expected);
+		EXPECT_TRUE(q.empty());
+	}
+}
+
+TEST(update_queue,cancel_drops_pending_and_batched_updates)
+{
+	cdk::update_queue q;
+	int a = 0;
+	int b = 0;
+	int c = 0;
+	std::vector<std::string> applied;
+	q.post(&a,cdk::update_queue::value,0,[&]{ applied.push_back("a0"); });
+	q.post(&c,cdk::update_queue::value,0,[&]{
+		applied.push_back("c0");
+		q.cancel(&a);
+	});
+	q.post(&a,cdk::update_queue::message,0,[&]{ applied.push_back("a1"); });
+	q.post(&b,cdk::update_queue::value,0,[&]{ applied.push_back("b0"); });
+	q.post(&b,cdk::update_queue::message,0,[&]{ applied.push_back("b1"); });
+	q.cancel(&b);
+	q.post(&b,cdk::update_queue::marker,0,[&]{ applied.push_back("b2"); });
+	EXPECT_EQ(q.drain(),3u);
+	EXPECT_EQ(applied,(std::vector<std::string>{"a0","c0","b2"}));
+}
+
+TEST(update_queue,posts_from_many_threads)
+{
+	cdk::update_queue q;
+	constexpr int threads = 4;
+	constexpr int per_thread = 10000;
+	std::vector<int> seen(threads * per_thread);
+	std::vector<std::thread> producers;
+	std::size_t applied = 0;
+	for (int t = 0; t < threads; ++t)
+	{
+		producers.emplace_back([&q,&seen,t]{
+			for (int i = 0; i < per_thread; ++i)
+			{
+				int id = t * per_thread + i;
+				q.post([&seen,id]{ ++seen[id]; });
+			}
+		});
+	}
+	while (applied < seen.size())
+		applied += q.drain();
+	for (auto& p : producers)
+		p.join();
+	EXPECT_EQ(q.drain(),0u);
+	EXPECT_EQ(std::count(seen.begin(),seen.end(),1),static_cast<long>(seen.size()));
+}
+
+TEST(alpha_list,applyDiff_matches_a_sorted_multiset)
+{
+	cdk::screen s(terminal().window());
+	for (int round = 0; round < 30; ++round)
+	{
+		auto items = randomStrings(200,3,"abc");
+		cdk::alpha_list list(s,{0,0},{30,12},"","l",cdk::StringList(items.begin(),items.end()),'_',0,{});
+		std::multiset<std::string> expected(items.begin(),items.end());
+		for (int step = 0; step < 10; ++step)
+		{
+			auto removed = randomStrings(randomBelow(20),3,"abcd");
+			auto added = randomStrings(randomBelow(20),3,"abcd");
+			list.applyDiff(cdk::StringList(removed.begin(),removed.end()),
+			               cdk::StringList(added.begin(),added.end()));
+			for (auto& r : removed)
+			{
+				auto it = expected.find(r);
+				if (it != expected.end())
+					expected.erase(it);
+			}
+			expected.insert(added.begin(),added.end());
+			ASSERT_EQ(strings(list.getContents()),std::vector<std::string>(expected.begin(),expected.end()));
+		}
+		auto item = randomString(3,"abcd");
+		list.insert(item);
+		expected.insert(item);
+		item = randomString(3,"abcd");
+		EXPECT_EQ(list.erase(item),expected.count(item) != 0);
+		if (expected.count(item))
+			expected.erase(expected.find(item));
+		EXPECT_EQ(strings(list.getContents()),std::vector<std::string>(expected.begin(),expected.end()));
+	}
+}
+
+TEST(findSubstring,matches_string_view_find)
+{
+	for (int round = 0; round < 20000; ++round)
+	{
+		std::string text = randomString(80,"ab\n");
+		std::string pattern = randomString(6,"ab\n");
+		//offset the text so the unaligned loads start anywhere
+		std::size_t offset = randomBelow(16);
+		std::string buffer = std::string(offset,'x') + text;
+		std::string_view view = std::string_view(buffer).substr(offset);
+		auto pos = view.find(pattern);
+		const char* expected = pos == std::string_view::npos ? nullptr : view.data() + pos;
+		ASSERT_EQ(cdk::findSubstring(view,pattern),expected) << '"' << text << "\" \"" << pattern << '"';
+	}
+}
+
+TEST(list_matcher,refined_matches_equal_a_full_search)
+{
+	auto items = randomStrings(2000,12,"abcAB-");
+	for (auto mode : {cdk::match_mode::prefix,cdk::match_mode::substring,cdk::match_mode::fuzzy})
+	{
+		cdk::list_matcher matcher(mode);
+		cdk::list_matcher fresh(mode);
+		for (int round = 0; round < 50; ++round)
+		{
+			//grow the query one character at a time, sometimes start over
+			std::string query;
+			for (std::size_t length = randomBelow(6); query.size() < length;)
+			{
+				query += "abcAB-"[randomBelow(6)];
+				fresh.reset();
+				ASSERT_EQ(matcher.match(items,query),fresh.match(items,query));
+				std::vector<std::size_t> expected;
+				for (std::size_t i = 0; i < items.size(); ++i)
+				{
+					std::string_view item = items[i];
+					bool matches = false;
+					switch (mode)
+					{
+					case cdk::match_mode::prefix:
+						matches = item.substr(0,query.size()) == query;
+						break;
+					case cdk::match_mode::substring:
+						matches = item.find(query) != std::string_view::npos;
+						break;
+					case cdk::match_mode::fuzzy:
+						matches = cdk::fuzzyScore(item,query) >= 0;
+						break;
+					}
+					if (matches)
+						expected.push_back(i);
+				}
+				ASSERT_EQ(matcher.matches(),expected) << query;
+			}
+		}
+	}
+}
+
+TEST(fuzzyScore,accepts_exactly_the_subsequences)
+{
+	for (int round = 0; round < 20000; ++round)
+	{
+		std::string text = randomString(10,"abAB");
+		std::string pattern = randomString(4,"abAB");
+		std::size_t t = 0;
+		for (char c : pattern)
+		{
+			while (t < text.size() && tolower(text[t]) != tolower(c))
+				++t;
+			if (t < text.size())
+				++t;
+			else
+				t = text.size() + 1;
+		}
+		bool expected = t <= text.size();
+		ASSERT_EQ(cdk::fuzzyScore(text,pattern) >= 0,expected) << text << ' ' << pattern;
+	}
+}
+
+TEST(alpha_list,filter_shows_the_matching_items)
+{
+	cdk::screen s(terminal().window());
+	auto items = randomStrings(3000,8,"abcd");
+	cdk::alpha_list list(s,{0,0},{30,12},"","l",cdk::StringList(items.begin(),items.end()),'_',0,{});
+	std::vector<std::string> sorted = items;
+	std::sort(sorted.begin(),sorted.end());
+	std::string query;
+	for (char c : std::string("abcab"))
+	{
+		query += c;
+		list.filter(query);
+		std::vector<std::string> expected;
+		for (auto& item : sorted)
+		{
+			if (item.find(query) != std::string::npos)
+				expected.push_back(item);
+		}
+		ASSERT_EQ(strings(list.getContents()),expected) << query;
+	}
+	list.setContents(cdk::StringList{"b","a"});
+	EXPECT_TRUE(list.getFilter().empty());
+	EXPECT_EQ(strings(list.getContents()),(std::vector<std::string>{"a","b"}));
+}
+
+TEST(prepareList,matches_a_single_threaded_reference)
+{
+	//long enough to be split among threads
+	auto items = randomStrings(40000,6,"abcABC");
+	cdk::StringList views(items.begin(),items.end());
+	for (unsigned threads : {1u,2u,3u,4u,0u})
+	{
+		for (int options = 0; options < 8; ++options)
+		{
+			cdk::list_preparation prep;
+			prep.sort = options & 1;
+			prep.unique = options & 2;
+			prep.foldCase = options & 4;
+			prep.threads = threads;
+
+			std::vector<std::string> expected = items;
+			if (prep.foldCase)
+			{
+				for (auto& item : expected)
+					std::transform(item.begin(),item.end(),item.begin(),[](unsigned char c){ return static_cast<char>(tolower(c)); });
+			}
+			if (prep.sort)
+			{
+				std::sort(expected.begin(),expected.end());
+				if (prep.unique)
+					expected.erase(std::unique(expected.begin(),expected.end()),expected.end());
+			}
+			else if (prep.unique)
+			{
+				std::vector<std::string> firsts;
+				std::set<std::string> seen;
+				for (auto& item : expected)
+				{
+					if (seen.insert(item).second)
+						firsts.push_back(item);
+				}
+				expected = std::move(firsts);
+			}
+
+			cdk::string_pool pool;
+			auto copied = cdk::prepareList(views,pool,prep);
+			ASSERT_EQ(strings(copied),expected) << "threads " << threads << " options " << options;
+			for (auto item : copied)
+				ASSERT_EQ(item.data()[item.size()],'\0');
+
+			cdk::string_pool movedPool;
+			auto moved = cdk::prepareList(std::vector<std::string>(items),movedPool,prep);
+			ASSERT_EQ(strings(moved),expected) << "threads " << threads << " options " << options;
+
+			ASSERT_EQ(cdk::prepareList(views,prep),expected) << "threads " << threads << " options " << options;
+		}
+	}
+}
+
+TEST(ring_buffer,matches_a_bounded_deque)
+{
+	for (std::size_t capacity : {1u,2u,5u,64u})
+	{
+		cdk::ring_buffer<std::string> ring(capacity);
+		std::deque<std::string> expected;
+		std::size_t dropped = 0;
+		for (int step = 0; step < 2000; ++step)
+		{
+			if (randomBelow(100) == 0)
+			{
+				dropped += expected.size();
+				expected.clear();
+				ring.clear();
+			}
+			else
+			{
+				std::string value = std::to_string(step);
+				ring.push_back(value);
+				expected.push_back(value);
+				if (expected.size() > capacity)
+				{
+					expected.pop_front();
+					++dropped;
+				}
+			}
+			ASSERT_EQ(ring.size(),expected.size());
+			ASSERT_EQ(ring.first(),dropped);
+			for (std::size_t i = 0; i < expected.size(); ++i)
+				ASSERT_EQ(ring[i],expected[i]) << "capacity " << capacity << " step " << step;
+		}
+	}
+}
+
+TEST(splitLines,matches_a_byte_by_byte_split)
+{
+	for (int round = 0; round < 20000; ++round)
+	{
+		std::string chunk = randomString(70,"a\n");
+		std::size_t offset = randomBelow(16);
+		std::string buffer = std::string(offset,'\n') + chunk;
+		std::string_view view = std::string_view(buffer).substr(offset);
+
+		std::vector<std::string> expected;
+		std::string rest;
+		for (char c : chunk)
+		{
+			if (c == '\n')
+				expected.push_back(std::exchange(rest,{}));
+			else
+				rest += c;
+		}
+		std::vector<std::string> lines;
+		auto tail = cdk::splitLines(view,[&](std::string_view line){ lines.emplace_back(line); });
+		ASSERT_EQ(lines,expected) << '"' << chunk << '"';
+		ASSERT_EQ(tail,rest);
+	}
+}
+
+TEST(splitLines,gives_the_same_lines_for_any_chunking)
+{
+	std::string text;
+	for (auto& line : randomStrings(5000,40,"abc"))
+		text += line + '\n';
+	std::vector<std::string> expected;
+	cdk::splitLines(text,[&](std::string_view line){ expected.emplace_back(line); });
+	for (int round = 0; round < 20; ++round)
+	{
+		std::vector<std::string> lines;
+		std::string partial;
+		for (std::size_t pos = 0; pos < text.size();)
+		{
+			std::size_t n = std::min(text.size() - pos,1 + randomBelow(100));
+			partial += text.substr(pos,n);
+			pos += n;
+			partial = std::string(cdk::splitLines(partial,[&](std::string_view line){ lines.emplace_back(line); }));
+		}
+		ASSERT_EQ(lines,expected);
+		ASSERT_TRUE(partial.empty());
+	}
+}
+
+TEST(line_index,matches_a_naive_split)
+{
+	//several 4 MiB chunks after the small first one, no final newline
+	std::string text;
+	for (std::size_t i = 0; text.size() < (10 << 20); ++i)
+		text += std::string(i * 7919 % 150,static_cast<char>('a' + i % 26)) + '\n';
+	text += "last";
+	auto expected = naiveLines(text);
+	for (unsigned threads : {1u,3u,0u})
+	{
+		std::atomic<int> published{0};
+		cdk::line_index index(text,[&]{ ++published; },threads);
+		std::size_t seen = 0;
+		while (!index.done())
+		{
+			//lines published so far are complete and only grow
+			std::size_t count = index.lineCount();
+			ASSERT_GE(count,seen);
+			ASSERT_LE(count,expected.size());
+			if (count)
+			{
+				ASSERT_EQ(index.line(count - 1),expected[count - 1]);
+			}
+			seen = count;
+			std::this_thread::yield();
+		}
+		ASSERT_EQ(index.lineCount(),expected.size());
+		EXPECT_EQ(index.indexedBytes(),text.size());
+		EXPECT_GT(published.load(),0);
+		auto all = index.lines(0,expected.size());
+		ASSERT_EQ(all.size(),expected.size());
+		for (std::size_t i = 0; i < expected.size(); ++i)
+			ASSERT_EQ(all[i],expected[i]) << "line " << i;
+		for (int probe = 0; probe < 1000; ++probe)
+		{
+			std::size_t i = randomBelow(expected.size());
+			ASSERT_EQ(index.line(i),expected[i]);
+		}
+		EXPECT_EQ(index.lines(expected.size() - 2,10).size(),2u);
+		EXPECT_TRUE(index.lines(expected.size(),10).empty());
+	}
+}
+
+TEST(line_index,handles_small_texts)
+{
+	for (std::string text : {"","\n","a","a\n","\n\nb","a\nb\n\n"})
+	{
+		cdk::line_index index(text,{},2);
+		while (!index.done())
+			std::this_thread::yield();
+		auto expected = naiveLines(text);
+		ASSERT_EQ(index.lineCount(),expected.size()) << '"' << text << '"';
+		auto lines = index.lines(0,expected.size());
+		EXPECT_EQ(std::vector<std::string_view>(lines.begin(),lines.end()),expected);
+	}
+}